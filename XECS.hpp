@@ -3,30 +3,63 @@
 #include <set>
 #include <map>
 #include <span>
+#include <array>
 #include <tuple>
 #include <queue>
+#include <mutex>
+#include <deque>
+#include <limits>
 #include <vector>
 #include <string>
+#include <atomic>
 #include <thread>
+#include <chrono>
 #include <future>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <stdexcept>
 #include <functional>
+#include <string_view>
 #include <type_traits>
+#include <shared_mutex>
 #include <unordered_map>
 #include <memory_resource>
-#include <condition_variable>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif// !NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif// _WIN32
 
 #ifndef X_ARCHETYPE_CHUNK_SIZE
 #define X_ARCHETYPE_CHUNK_SIZE (16384)
 #endif// !X_ARCHETYPE_CHUNK_SIZE
 
+#ifndef X_CACHE_LINE_SIZE
+#define X_CACHE_LINE_SIZE (64)
+#endif// !X_CACHE_LINE_SIZE
+
+#ifndef X_HUGE_PAGE_SIZE
+#define X_HUGE_PAGE_SIZE (2097152)
+#endif// !X_HUGE_PAGE_SIZE
+
 namespace X
 {
 	class world;
 	class entity;
 	class scheduler;
+	class entity_range;
 	class memory_resource;
 	template< typename T > class ptr;
 	template< typename T > class read;
@@ -34,21 +67,388 @@ namespace X
 	template< typename ... T > struct all;
 	template< typename ... T > struct any;
 	template< typename ... T > struct none;
+	template< typename ... T > struct changed;
+	template< std::size_t N > struct parallel;
 	template< typename T > class graph;
 
 	using type_id = std::string;
 	using hash_id = std::uint64_t;
+	using component_id = std::size_t;
 	using command = std::function<void()>;
 	using job_task = std::function<void()>;
-	using type_list = std::pmr::vector< type_id >;
-	using destructable = std::function<void( std::uint8_t * )>;
-	using constructable = std::function<void( std::uint8_t * )>;
-	using copy_assignable = std::function<void( std::uint8_t *, std::uint8_t * )>;
-	using serializable = std::function<void( std::ostream & , std::uint8_t * )>;
-	using deserializable = std::function<void( std::istream &, std::uint8_t * )>;
+	using type_list = std::pmr::vector< component_id >;
+	using destructable = void( * )( std::uint8_t * );
+	using constructable = void( * )( std::uint8_t * );
+	using copy_assignable = void( * )( std::uint8_t *, std::uint8_t * );
+	using serializable = void( * )( std::ostream &, std::uint8_t * );
+	using deserializable = void( * )( std::istream &, std::uint8_t * );
 
 	using system_callback = std::function<void( std::span< std::uint8_t * > )>;
-	
+	using system_kernel = std::function<void( std::span< std::uint8_t * >, std::size_t )>;
+
+	namespace detail
+	{
+		class scratch_arena
+		{
+		public:
+			struct mark
+			{
+				std::size_t block;
+				std::size_t offset;
+				std::size_t live;
+			};
+
+		private:
+			struct block
+			{
+				std::uint8_t * data;
+				std::size_t size;
+			};
+
+		public:
+			scratch_arena() = default;
+
+			scratch_arena( const scratch_arena & ) = delete;
+
+			~scratch_arena()
+			{
+				for ( const auto & it : _blocks )
+					std::pmr::new_delete_resource()->deallocate( it.data, it.size, alignof( std::max_align_t ) );
+			}
+
+		public:
+			static scratch_arena & instance()
+			{
+				thread_local scratch_arena arena;
+				return arena;
+			}
+
+		public:
+			void * allocate( std::size_t bytes, std::size_t alignment )
+			{
+				while ( true )
+				{
+					if ( _block < _blocks.size() )
+					{
+						auto & it = _blocks[_block];
+
+						std::uintptr_t address = reinterpret_cast<std::uintptr_t>( it.data + _offset );
+						address = ( address + alignment - 1 ) & ~( std::uintptr_t( alignment ) - 1 );
+
+						std::size_t offset = address - reinterpret_cast<std::uintptr_t>( it.data );
+						if ( offset + bytes <= it.size )
+						{
+							_live++;
+							_offset = offset + bytes;
+							return it.data + offset;
+						}
+
+						if ( _block + 1 < _blocks.size() )
+						{
+							_block++;
+							_offset = 0;
+							continue;
+						}
+					}
+
+					std::size_t size = std::max< std::size_t >( _blocks.empty() ? 64 * 1024 : _blocks.back().size * 2, bytes + alignment );
+					_blocks.push_back( { reinterpret_cast<std::uint8_t *>( std::pmr::new_delete_resource()->allocate( size, alignof( std::max_align_t ) ) ), size } );
+					_block = _blocks.size() - 1;
+					_offset = 0;
+				}
+			}
+
+			void deallocate( void * ptr, std::size_t bytes )
+			{
+				if ( _live == 0 )
+					return;
+
+				if ( --_live == 0 )
+				{
+					_block = 0;
+					_offset = 0;
+				}
+				else if ( _block < _blocks.size() && reinterpret_cast<std::uint8_t *>( ptr ) + bytes == _blocks[_block].data + _offset )
+				{
+					_offset = reinterpret_cast<std::uint8_t *>( ptr ) - _blocks[_block].data;
+				}
+			}
+
+			mark save() const
+			{
+				return { _block, _offset, _live };
+			}
+
+			void rewind( const mark & val )
+			{
+				_block = val.block;
+				_offset = val.offset;
+				_live = val.live;
+			}
+
+		private:
+			std::size_t _live = 0;
+			std::size_t _block = 0;
+			std::size_t _offset = 0;
+			std::vector< block > _blocks;
+		};
+
+		class scratch_scope
+		{
+		public:
+			scratch_scope()
+				: _arena( scratch_arena::instance() ), _mark( _arena.save() )
+			{
+
+			}
+
+			scratch_scope( const scratch_scope & ) = delete;
+
+			~scratch_scope()
+			{
+				_arena.rewind( _mark );
+			}
+
+		private:
+			scratch_arena & _arena;
+			scratch_arena::mark _mark;
+		};
+
+		class mapped_file
+		{
+		public:
+			mapped_file() = default;
+
+			mapped_file( const mapped_file & ) = delete;
+
+			mapped_file( mapped_file && val ) noexcept
+				: _data( std::exchange( val._data, nullptr ) ), _size( std::exchange( val._size, 0 ) )
+			{
+
+			}
+
+			~mapped_file()
+			{
+				close();
+			}
+
+		public:
+			bool open( const std::string & path )
+			{
+				close();
+
+#if defined( _WIN32 )
+				HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+				if ( file == INVALID_HANDLE_VALUE )
+					return false;
+
+				LARGE_INTEGER size;
+				HANDLE mapping = GetFileSizeEx( file, &size ) && size.QuadPart != 0 ? CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr ) : nullptr;
+				CloseHandle( file );
+				if ( mapping == nullptr )
+					return false;
+
+				void * data = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+				CloseHandle( mapping );
+				if ( data == nullptr )
+					return false;
+
+				_data = reinterpret_cast<std::uint8_t *>( data );
+				_size = static_cast<std::size_t>( size.QuadPart );
+#else
+				int file = ::open( path.c_str(), O_RDONLY );
+				if ( file < 0 )
+					return false;
+
+				struct stat st;
+				void * data = fstat( file, &st ) == 0 && st.st_size != 0 ? mmap( nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 ) : MAP_FAILED;
+				::close( file );
+				if ( data == MAP_FAILED )
+					return false;
+
+				_data = reinterpret_cast<std::uint8_t *>( data );
+				_size = static_cast<std::size_t>( st.st_size );
+#endif// _WIN32
+
+				return true;
+			}
+
+			void close()
+			{
+				if ( _data == nullptr )
+					return;
+
+#if defined( _WIN32 )
+				UnmapViewOfFile( _data );
+#else
+				munmap( _data, _size );
+#endif// _WIN32
+
+				_data = nullptr;
+				_size = 0;
+			}
+
+		public:
+			std::uint8_t * data() const
+			{
+				return _data;
+			}
+
+			std::size_t size() const
+			{
+				return _size;
+			}
+
+		private:
+			std::uint8_t * _data = nullptr;
+			std::size_t _size = 0;
+		};
+
+		class memory_buffer : public std::streambuf
+		{
+		public:
+			memory_buffer( const std::uint8_t * data, std::size_t size )
+			{
+				char * first = const_cast<char *>( reinterpret_cast<const char *>( data ) );
+				setg( first, first, first + size );
+			}
+
+		protected:
+			pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which ) override
+			{
+				char * pos = dir == std::ios_base::beg ? eback() + off : dir == std::ios_base::cur ? gptr() + off : egptr() + off;
+				if ( pos < eback() || pos > egptr() )
+					return pos_type( off_type( -1 ) );
+
+				setg( eback(), pos, egptr() );
+				return pos_type( pos - eback() );
+			}
+
+			pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override
+			{
+				return seekoff( off_type( pos ), std::ios_base::beg, which );
+			}
+		};
+
+		class frame_arena : public std::pmr::memory_resource
+		{
+		private:
+			struct overflow
+			{
+				void * ptr;
+				std::size_t bytes;
+				std::size_t alignment;
+			};
+
+		public:
+			frame_arena( std::pmr::memory_resource * upstream, std::size_t capacity = 64 * 1024 )
+				: _capacity( capacity ), _upstream( upstream ), _overflows( upstream )
+			{
+				_buffer = reinterpret_cast<std::uint8_t *>( _upstream->allocate( _capacity, alignof( std::max_align_t ) ) );
+			}
+
+			frame_arena( const frame_arena & ) = delete;
+
+			~frame_arena()
+			{
+				for ( const auto & it : _overflows )
+					_upstream->deallocate( it.ptr, it.bytes, it.alignment );
+
+				_upstream->deallocate( _buffer, _capacity, alignof( std::max_align_t ) );
+			}
+
+		public:
+			void reset()
+			{
+				std::unique_lock< std::mutex > lock( _mutex );
+
+				std::size_t grow = 0;
+				for ( const auto & it : _overflows )
+				{
+					grow += it.bytes + it.alignment;
+					_upstream->deallocate( it.ptr, it.bytes, it.alignment );
+				}
+				_overflows.clear();
+
+				if ( grow != 0 )
+				{
+					_upstream->deallocate( _buffer, _capacity, alignof( std::max_align_t ) );
+					_capacity = std::max( _capacity * 2, _capacity + grow );
+					_buffer = reinterpret_cast<std::uint8_t *>( _upstream->allocate( _capacity, alignof( std::max_align_t ) ) );
+				}
+
+				_offset.store( 0, std::memory_order_relaxed );
+			}
+
+		private:
+			void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+			{
+				std::uintptr_t base = reinterpret_cast<std::uintptr_t>( _buffer );
+
+				std::size_t offset = _offset.load( std::memory_order_relaxed );
+				while ( true )
+				{
+					std::size_t first = ( ( base + offset + alignment - 1 ) / alignment * alignment ) - base;
+					if ( first + bytes > _capacity )
+						break;
+
+					if ( _offset.compare_exchange_weak( offset, first + bytes, std::memory_order_relaxed ) )
+						return _buffer + first;
+				}
+
+				std::unique_lock< std::mutex > lock( _mutex );
+
+				void * ptr = _upstream->allocate( bytes, alignment );
+				_overflows.push_back( { ptr, bytes, alignment } );
+				return ptr;
+			}
+
+			void do_deallocate( void * ptr, std::size_t bytes, std::size_t alignment ) override
+			{
+
+			}
+
+			bool do_is_equal( const std::pmr::memory_resource & other ) const noexcept override
+			{
+				return this == &other;
+			}
+
+		private:
+			std::mutex _mutex;
+			std::size_t _capacity;
+			std::uint8_t * _buffer;
+			std::atomic< std::size_t > _offset = 0;
+			std::pmr::memory_resource * _upstream;
+			std::pmr::vector< overflow > _overflows;
+		};
+	}
+
+	class scratch_resource : public std::pmr::memory_resource
+	{
+	public:
+		static scratch_resource * instance()
+		{
+			static scratch_resource resource;
+			return &resource;
+		}
+
+	private:
+		void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+		{
+			return detail::scratch_arena::instance().allocate( bytes, alignment );
+		}
+
+		void do_deallocate( void * ptr, std::size_t bytes, std::size_t alignment ) override
+		{
+			detail::scratch_arena::instance().deallocate( ptr, bytes );
+		}
+
+		bool do_is_equal( const std::pmr::memory_resource & other ) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
 	class memory_resource
 	{
 	public:
@@ -62,6 +462,150 @@ namespace X
 		std::pmr::memory_resource * callstack_resource = std::pmr::get_default_resource();
 	};
 
+	class huge_page_resource : public std::pmr::memory_resource
+	{
+	private:
+		struct region
+		{
+			void * address;
+			std::size_t size;
+		};
+
+	public:
+		huge_page_resource( std::size_t region_size = 16 * X_HUGE_PAGE_SIZE, bool explicit_huge_pages = false )
+			: _explicit( explicit_huge_pages ), _region_size( align_up( region_size, X_HUGE_PAGE_SIZE ) )
+		{
+
+		}
+
+		huge_page_resource( const huge_page_resource & ) = delete;
+
+		~huge_page_resource()
+		{
+			for ( const auto & it : _regions )
+				unmap( it.address, it.size );
+		}
+
+	private:
+		void * do_allocate( std::size_t bytes, std::size_t alignment ) override
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			bytes = align_up( bytes, alignment );
+
+			auto it = _frees.find( bytes );
+			if ( it != _frees.end() && !it->second.empty() )
+			{
+				void * block = it->second.back();
+				it->second.pop_back();
+				return block;
+			}
+
+			if ( bytes > _region_size )
+			{
+				std::size_t size = align_up( bytes, X_HUGE_PAGE_SIZE );
+				void * block = map( size );
+				_regions.push_back( { block, size } );
+				return block;
+			}
+
+			std::size_t offset = align_up( _offset, alignment );
+			if ( _current == nullptr || offset + bytes > _region_size )
+			{
+				_current = reinterpret_cast<std::uint8_t *>( map( _region_size ) );
+				_regions.push_back( { _current, _region_size } );
+				offset = 0;
+			}
+
+			_offset = offset + bytes;
+
+			return _current + offset;
+		}
+
+		void do_deallocate( void * block, std::size_t bytes, std::size_t alignment ) override
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			_frees[align_up( bytes, alignment )].push_back( block );
+		}
+
+		bool do_is_equal( const std::pmr::memory_resource & other ) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		void * map( std::size_t size )
+		{
+#if defined( _WIN32 )
+			void * block = nullptr;
+
+			SIZE_T large_page = GetLargePageMinimum();
+			if ( _explicit && large_page != 0 && size % large_page == 0 )
+				block = VirtualAlloc( nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+
+			if ( block == nullptr )
+				block = VirtualAlloc( nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+
+			if ( block == nullptr )
+				throw std::bad_alloc();
+
+			return block;
+#else
+#ifdef MAP_HUGETLB
+			if ( _explicit )
+			{
+				void * block = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+				if ( block != MAP_FAILED )
+					return block;
+			}
+#endif// MAP_HUGETLB
+
+			std::size_t total = size + X_HUGE_PAGE_SIZE;
+			void * addr = mmap( nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+			if ( addr == MAP_FAILED )
+				throw std::bad_alloc();
+
+			std::uint8_t * first = reinterpret_cast<std::uint8_t *>( addr );
+			std::uint8_t * block = reinterpret_cast<std::uint8_t *>( align_up( reinterpret_cast<std::uintptr_t>( first ), X_HUGE_PAGE_SIZE ) );
+
+			if ( block != first )
+				munmap( first, block - first );
+			if ( first + total != block + size )
+				munmap( block + size, ( first + total ) - ( block + size ) );
+
+#ifdef MADV_HUGEPAGE
+			madvise( block, size, MADV_HUGEPAGE );
+#endif// MADV_HUGEPAGE
+
+			return block;
+#endif// _WIN32
+		}
+
+		void unmap( void * block, std::size_t size )
+		{
+#if defined( _WIN32 )
+			VirtualFree( block, 0, MEM_RELEASE );
+#else
+			munmap( block, size );
+#endif// _WIN32
+		}
+
+		static std::size_t align_up( std::size_t value, std::size_t align )
+		{
+			return ( value + align - 1 ) / align * align;
+		}
+
+	private:
+		std::mutex _mutex;
+		bool _explicit;
+		std::size_t _offset = 0;
+		std::size_t _region_size;
+		std::uint8_t * _current = nullptr;
+		std::vector< region > _regions;
+		std::unordered_map< std::size_t, std::vector< void * > > _frees;
+	};
+
 	template< typename T > class ptr
 	{
 	public:
@@ -149,6 +693,7 @@ namespace X
 		using ptr< T >::ptr;
 	};
 	template< typename T > struct is_write : public std::false_type {}; template< typename T > struct is_write< write< T > > : public std::true_type {}; template< typename T > constexpr const bool is_write_v = is_write< T >::value;
+	template< typename T > struct is_span : public std::false_type {}; template< typename T > struct is_span< std::span< T > > : public std::true_type {}; template< typename T > constexpr const bool is_span_v = is_span< T >::value;
 
 	template<> struct all<> { using this_type = std::identity; };
 	template< typename T, typename ... Args > struct all< T, Args... > : private all< Args... > { using this_type = T; using base_type = all< Args... >; };
@@ -159,89 +704,313 @@ namespace X
 	template<> struct none<> { using this_type = std::identity; };
 	template< typename T, typename ... Args > struct none< T, Args... > : private none< Args... > { using this_type = T; using base_type = none< Args... >; };
 	template< typename ... T > struct is_none : public std::false_type {}; template< typename ... T > struct is_none< none< T... > > : public std::true_type {}; template< typename T > constexpr const bool is_none_v = is_none<T>::value;
+	template<> struct changed<> { using this_type = std::identity; };
+	template< typename T, typename ... Args > struct changed< T, Args... > : private changed< Args... > { using this_type = T; using base_type = changed< Args... >; };
+	template< typename ... T > struct is_changed : public std::false_type {}; template< typename ... T > struct is_changed< changed< T... > > : public std::true_type {}; template< typename T > constexpr const bool is_changed_v = is_changed<T>::value;
 	template< typename ... T > struct is_filter : public std::false_type {};
 	template< typename ... T > struct is_filter< all< T... > > : public std::true_type {};
 	template< typename ... T > struct is_filter< any< T... > > : public std::true_type {};
 	template< typename ... T > struct is_filter< none< T... > > : public std::true_type {};
+	template< typename ... T > struct is_filter< changed< T... > > : public std::true_type {};
 	template< typename T > constexpr const bool is_filter_v = is_filter<T>::value;
+	template< std::size_t N > struct parallel { static constexpr std::size_t batch = N; };
+	template< typename T > struct is_parallel : public std::false_type {}; template< std::size_t N > struct is_parallel< parallel< N > > : public std::true_type {}; template< typename T > constexpr const bool is_parallel_v = is_parallel<T>::value;
 
 	namespace detail
 	{
 		static constexpr const std::size_t npos = static_cast<std::size_t>( -1 );
+		static constexpr const std::size_t world_column = npos;
+		static constexpr const std::size_t entity_column = npos - 1;
 
-		struct address
+		struct archetype_info;
+
+		constexpr hash_id hash( std::string_view name )
 		{
-			bool operator<( const address & addr ) const
+			std::uint64_t _Val = 14695981039346656037ULL;
+			for ( auto c : name )
 			{
-				return chunk_index < addr.chunk_index ? true : chunk_index == addr.chunk_index ? address_index < addr.address_index : false;
+				_Val ^= static_cast<std::uint8_t>( c );
+				_Val *= 1099511628211ULL;
 			}
+			return _Val;
+		}
 
-			std::size_t chunk_index = npos;
-			std::size_t address_index = npos;
-		};
+		constexpr hash_id mix( std::uint64_t _Val )
+		{
+			_Val += 0x9E3779B97F4A7C15ULL;
+			_Val = ( _Val ^ ( _Val >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+			_Val = ( _Val ^ ( _Val >> 27 ) ) * 0x94D049BB133111EBULL;
+			return _Val ^ ( _Val >> 31 );
+		}
 
-		struct entity_info
+		class component_registry
 		{
-			hash_id type;
-			address address;
+		public:
+			static component_registry & instance()
+			{
+				static component_registry registry;
+				return registry;
+			}
+
+		public:
+			component_id id( std::string_view name )
+			{
+				return id( X::detail::hash( name ), name );
+			}
+
+			component_id id( hash_id hash, std::string_view name )
+			{
+				{
+					std::shared_lock< std::shared_mutex > lock( _mutex );
+
+					auto it = find( hash, name );
+					if ( it != _ids.end() )
+						return it->second;
+				}
+
+				std::unique_lock< std::shared_mutex > lock( _mutex );
+
+				auto it = find( hash, name );
+				if ( it != _ids.end() )
+					return it->second;
+
+				while ( _ids.find( hash ) != _ids.end() )
+					hash++;
+
+				component_id id = _names.size();
+				_names.emplace_back( name );
+				_ids.insert( { hash, id } );
+				return id;
+			}
+
+			type_id name( component_id id ) const
+			{
+				std::shared_lock< std::shared_mutex > lock( _mutex );
+
+				return id < _names.size() ? _names[id] : type_id();
+			}
+
+		private:
+			std::unordered_map< hash_id, component_id >::const_iterator find( hash_id hash, std::string_view name ) const
+			{
+				for ( auto it = _ids.find( hash ); it != _ids.end(); it = _ids.find( ++hash ) )
+				{
+					if ( _names[it->second] == name )
+						return it;
+				}
+				return _ids.end();
+			}
+
+		private:
+			mutable std::shared_mutex _mutex;
+			std::deque< type_id > _names;
+			std::unordered_map< hash_id, component_id > _ids;
+		};
+
+		struct address
+		{
+			bool operator<( const address & addr ) const
+			{
+				return chunk_index < addr.chunk_index ? true : chunk_index == addr.chunk_index ? address_index < addr.address_index : false;
+			}
+
+			std::size_t chunk_index = npos;
+			std::size_t address_index = npos;
+		};
+
+		struct entity_info
+		{
+			hash_id type;
+			X::detail::address address;
 			std::uint64_t id;
+			std::uint32_t generation = 0;
+		};
+
+		struct query_info
+		{
+			query_info( archetype_info * archetype, std::pmr::memory_resource * resource )
+				: archetype( archetype ), writes( resource ), changes( resource ), columns( resource ), strides( resource )
+			{
+
+			}
+
+			archetype_info * archetype;
+			std::pmr::vector< std::size_t > writes;
+			std::pmr::vector< std::size_t > changes;
+			std::pmr::vector< std::size_t > columns;
+			std::pmr::vector< std::size_t > strides;
 		};
 
 		struct system_info
 		{
 			system_info( X::memory_resource * resource )
-				: alls( resource->system_resource ), anys( resource->system_resource ), nones( resource->system_resource ), reads( resource->system_resource ), writes( resource->system_resource ), arguments( resource->system_resource )
+				: alls( resource->system_resource ), anys( resource->system_resource ), nones( resource->system_resource ), changes( resource->system_resource ), reads( resource->system_resource ), writes( resource->system_resource ), arguments( resource->system_resource ), archetypes( resource->system_resource )
 			{
 
 			}
 
 			bool enable = true;
+			std::size_t batch = 0;
+			std::size_t order = 0;
 			type_id type;
 			type_list alls;
 			type_list anys;
 			type_list nones;
+			type_list changes;
 			type_list reads;
 			type_list writes;
 			type_list arguments;
+			system_kernel kernel;
 			system_callback function;
+
+			std::size_t matched = 0;
+			std::uint64_t version = 0;
+			std::pmr::vector< query_info > archetypes;
 		};
 
 		struct component_info
 		{
+		public:
+			void construct_range( std::uint8_t * ptr, std::size_t count ) const
+			{
+				if ( zero_initializable || construct == nullptr )
+				{
+					std::memset( ptr, 0, size * count );
+				}
+				else
+				{
+					for ( size_t i = 0; i < count; i++ )
+						construct( ptr + i * size );
+				}
+			}
+
+			void destruct_range( std::uint8_t * ptr, std::size_t count ) const
+			{
+				if ( trivially_destructible || destruct == nullptr )
+					return;
+
+				for ( size_t i = 0; i < count; i++ )
+					destruct( ptr + i * size );
+			}
+
+			bool bitwise_copyable() const
+			{
+				return trivially_copyable || copyassgin == nullptr;
+			}
+
+			void copy_range( std::uint8_t * dst, std::uint8_t * src, std::size_t count ) const
+			{
+				if ( bitwise_copyable() )
+				{
+					std::memcpy( dst, src, size * count );
+				}
+				else
+				{
+					for ( size_t i = 0; i < count; i++ )
+						copyassgin( dst + i * size, src + i * size );
+				}
+			}
+
+		public:
 			type_id type;
-			std::size_t size;
-			destructable destruct;
-			constructable construct;
-			copy_assignable copyassgin;
-			serializable serialize;
-			deserializable deserialize;
+			component_id id = npos;
+			std::size_t size = 0;
+			std::size_t align = alignof( std::max_align_t );
+			bool trivially_copyable = false;
+			bool trivially_destructible = false;
+			bool zero_initializable = false;
+			destructable destruct = nullptr;
+			constructable construct = nullptr;
+			copy_assignable copyassgin = nullptr;
+			serializable serialize = nullptr;
+			deserializable deserialize = nullptr;
+		};
+
+		inline hash_id hash_code( std::span< const component_info > components )
+		{
+			std::uint64_t _Val = 14695981039346656037ULL;
+			for ( const auto & it : components )
+				_Val ^= mix( it.id );
+			return _Val;
+		}
+
+		class chunk_pool
+		{
+		public:
+			chunk_pool( std::pmr::memory_resource * resource, std::size_t size, std::size_t align )
+				: _size( size ), _align( align ), _resource( resource ), _frees( resource )
+			{
+
+			}
+
+			chunk_pool( const chunk_pool & ) = delete;
+
+			~chunk_pool()
+			{
+				for ( auto it : _frees )
+					_resource->deallocate( it, _size, _align );
+			}
+
+		public:
+			std::size_t block_size() const
+			{
+				return _size;
+			}
+
+			void * allocate()
+			{
+				if ( _frees.empty() )
+					return _resource->allocate( _size, _align );
+
+				void * block = _frees.back();
+				_frees.pop_back();
+				return block;
+			}
+
+			void deallocate( void * block )
+			{
+				_frees.push_back( block );
+			}
+
+			void shrink()
+			{
+				for ( auto it : _frees )
+					_resource->deallocate( it, _size, _align );
+				_frees.clear();
+			}
+
+		private:
+			std::size_t _size;
+			std::size_t _align;
+			std::pmr::memory_resource * _resource;
+			std::pmr::vector< void * > _frees;
 		};
 
 		struct archetype_info
 		{
 		public:
-			class chunk
+			class alignas( X_CACHE_LINE_SIZE ) chunk
 			{
 			public:
-				chunk( X::memory_resource * resource, std::span<component_info> components )
-					: _bits( resource->archetype_resource )
+				chunk( std::size_t capacity, std::span<const std::size_t> offsets, std::span<component_info> components, std::size_t count = 0, bool mapped = false )
 				{
-					std::fill( _data, _data + X_ARCHETYPE_CHUNK_SIZE, 0 );
-
-					std::size_t total_size = 0;
-					for ( const auto & it : components )
-						total_size += it.size;
-
-					_count = 0;
+					_count = count;
+					_mapped = mapped;
+					_capacity = capacity;
+					_offsets = offsets;
 					_components = components;
+				}
 
-					_bits.resize( X_ARCHETYPE_CHUNK_SIZE / total_size );
+				~chunk()
+				{
+					for ( size_t i = 0; i < _components.size(); i++ )
+						_components[i].destruct_range( component_address( i ), _count );
 				}
 
 			public:
 				bool full() const
 				{
-					return _count == _bits.size();
+					return _count == _capacity;
 				}
 
 				bool empty() const
@@ -256,131 +1025,213 @@ namespace X
 
 				std::size_t capacity() const
 				{
-					return _bits.size();
+					return _capacity;
+				}
+
+				bool mapped() const
+				{
+					return _mapped;
 				}
 
 			public:
+				std::uint8_t * data()
+				{
+					return reinterpret_cast<std::uint8_t *>( this + 1 );
+				}
+
+				std::uint64_t * versions()
+				{
+					return reinterpret_cast<std::uint64_t *>( data() + _offsets[_components.size()] );
+				}
+
+				void touch( std::uint64_t version )
+				{
+					std::fill_n( versions(), _components.size(), version );
+				}
+
 				std::uint8_t * address( std::size_t index, std::size_t component_info )
 				{
 					return component_address( component_info ) + ( index * _components[component_info].size );
 				}
 
-				std::size_t alloc()
+				std::uint64_t * entitys()
 				{
-					if ( !full() )
-					{
-						auto it = std::find( _bits.begin(), _bits.end(), false );
-						if ( it != _bits.end() )
-						{
-							*it = true;
-							_count++;
+					return reinterpret_cast<std::uint64_t *>( data() );
+				}
 
-							return it - _bits.begin();
-						}
-					}
+				std::size_t alloc( std::uint64_t entity )
+				{
+					if ( full() )
+						return npos;
 
-					return npos;
+					entitys()[_count] = entity;
+
+					return _count++;
 				}
 
-				void free( std::size_t index )
+				template< typename I > std::size_t alloc( I && ids, std::size_t first, std::size_t count )
 				{
-					if ( !empty() )
-					{
-						_count--;
-						_bits[index] = false;
-					}
+					std::size_t size = std::min( count, _capacity - _count );
+
+					std::uint64_t * dst = entitys() + _count;
+					for ( size_t i = 0; i < size; i++ )
+						dst[i] = ids( first + i );
+
+					_count += size;
+
+					return size;
 				}
 
-				template< typename F > void foreach( X::detail::address addr, F & func )
+				std::uint64_t free( std::size_t index )
 				{
-					for ( size_t i = 0; i < _bits.size(); i++ )
+					if ( empty() )
+						return npos;
+
+					std::size_t last = --_count;
+					for ( size_t i = 0; i < _components.size(); i++ )
 					{
-						if ( _bits[i] )
-						{
-							addr.address_index = i;
-							func( addr );
-						}
+						if ( index != last )
+							_components[i].copy_range( address( index, i ), address( last, i ), 1 );
+
+						_components[i].destruct_range( address( last, i ), 1 );
 					}
+
+					if ( index == last )
+						return npos;
+
+					entitys()[index] = entitys()[last];
+
+					return entitys()[index];
 				}
 
 			private:
 				std::uint8_t * component_address( std::size_t component_info )
 				{
-					std::uint8_t * addr = _data;
-					for ( size_t i = 0; i < component_info; i++ )
-					{
-						addr += _components[i].size * _bits.size();
-					}
-					return addr;
+					return data() + _offsets[component_info];
 				}
 
 			private:
+				bool _mapped;
 				std::size_t _count;
-				std::pmr::vector<bool> _bits;
+				std::size_t _capacity;
+				std::span<const std::size_t> _offsets;
 				std::span<component_info> _components;
+			};
+
+			struct edge
+			{
+				edge( archetype_info * target, std::pmr::memory_resource * resource )
+					: target( target ), columns( resource )
+				{
+
+				}
 
-				std::uint8_t _data[X_ARCHETYPE_CHUNK_SIZE];
+				archetype_info * target;
+				std::pmr::vector< std::size_t > columns;
 			};
 
 		public:
-			archetype_info( X::memory_resource * resource, std::span<component_info> components )
-				: _resource( resource ), _chunks( resource->archetype_resource ), _components(components.begin(), components.end(), resource->archetype_resource), _entitys(resource->archetype_resource)
+			archetype_info( X::memory_resource * resource, chunk_pool * pool, const std::uint64_t * version, std::span<component_info> components )
+				: _pool( pool ), _version( version ), _resource( resource ), _chunks( resource->archetype_resource ), _frees( resource->archetype_resource ), _offsets( resource->archetype_resource ), _components(components.begin(), components.end(), resource->archetype_resource), _columns( resource->archetype_resource ), _attachs( resource->archetype_resource ), _detachs( resource->archetype_resource )
 			{
+				_hash = X::detail::hash_code( _components );
+
+				for ( size_t i = 0; i < _components.size(); i++ )
+				{
+					if ( _components[i].id == npos )
+						continue;
+
+					if ( _components[i].id >= _columns.size() )
+						_columns.resize( _components[i].id + 1, npos );
+					_columns[_components[i].id] = i;
+				}
+
+				std::size_t total_size = sizeof( std::uint64_t );
+				for ( const auto & it : _components )
+					total_size += it.size;
+
+				std::size_t chunk_size = _pool->block_size() - sizeof( chunk );
+
+				_capacity = chunk_size / total_size;
+				while ( _capacity > 1 && layout( _capacity ) > chunk_size )
+					_capacity--;
+
+				if ( _capacity == 0 || layout( _capacity ) > chunk_size )
+					throw std::length_error( "The archetype row does not fit in a chunk" );
 			}
 
 			~archetype_info()
 			{
-				for ( auto it : _chunks )
-				{
-					it->~chunk();
-					_resource->archetype_resource->deallocate( it, sizeof( chunk ) );
-				}
+				clear();
 			}
 
 		public:
-			address alloc( entity_info * entity )
+			address alloc( std::uint64_t entity )
 			{
 				address addr;
 
-				for ( size_t i = 0; i < _chunks.size(); i++ )
-				{
-					if ( !_chunks[i]->full() )
-					{
-						addr.chunk_index = i;
-						addr.address_index = _chunks[i]->alloc();
-						break;
-					}
-				}
+				if ( _frees.empty() )
+					new_chunk();
 
-				if ( addr.address_index == npos )
-				{
-					chunk * c = new ( _resource->archetype_resource->allocate( sizeof( chunk ) ) ) chunk( _resource, _components );
-					addr.chunk_index = _chunks.size();
-					addr.address_index = c->alloc();
-					_chunks.push_back( c );
-				}
+				addr.chunk_index = _frees.back();
+				addr.address_index = _chunks[addr.chunk_index]->alloc( entity );
+				_chunks[addr.chunk_index]->touch( *_version );
 
-				for ( size_t i = 0; i < _components.size(); i++ )
-				{
-					std::uint8_t * ptr = _chunks[addr.chunk_index]->address( addr.address_index, i );
-					_components[i].construct( ptr );
-				}
+				if ( _chunks[addr.chunk_index]->full() )
+					_frees.pop_back();
 
-				_entitys.insert( { addr, entity } );
+				for ( size_t i = 0; i < _components.size(); i++ )
+					_components[i].construct_range( _chunks[addr.chunk_index]->address( addr.address_index, i ), 1 );
 
 				return addr;
 			}
 
-			void free( address addr )
+			template< typename F > void alloc( std::uint64_t first, std::size_t count, F && func )
 			{
-				for ( size_t i = 0; i < _components.size(); i++ )
-				{
-					_components[i].destruct( component_address<std::uint8_t>( addr, i ) );
-				}
+				alloc_range( [first] ( std::size_t i ) { return first + i; }, count, func );
+			}
+
+			template< typename F > void alloc( std::span< const std::uint64_t > ids, F && func )
+			{
+				alloc_range( [ids] ( std::size_t i ) { return ids[i]; }, ids.size(), func );
+			}
+
+			std::size_t adopt( void * block, std::size_t count )
+			{
+				chunk * c = new ( block ) chunk( _capacity, _offsets, _components, count, true );
+				c->touch( *_version );
+
+				if ( !c->full() )
+					_frees.push_back( _chunks.size() );
+				_chunks.push_back( c );
+
+				return _chunks.size() - 1;
+			}
+
+			void clear()
+			{
+				for ( auto it : _chunks )
+					drop_chunk( it );
+
+				_chunks.clear();
+				_frees.clear();
+			}
+
+			template< typename F > void free( address addr, F && relocate )
+			{
+				chunk * c = _chunks[addr.chunk_index];
+
+				if ( c->full() )
+					_frees.push_back( addr.chunk_index );
+
+				std::uint64_t moved = c->free( addr.address_index );
+				if ( moved != npos )
+					relocate( moved, addr );
 
-				_chunks[addr.chunk_index]->free( addr.address_index );
+				c->touch( *_version );
 
-				_entitys.erase( _entitys.find( addr ) );
+				if ( c->empty() )
+					release_chunk( addr.chunk_index, relocate );
 			}
 
 			template< typename T > T * component_address( address addr, std::size_t component )
@@ -390,26 +1241,54 @@ namespace X
 
 			template< typename F > void foreach( F func )
 			{
-				for ( size_t i = 0; i < _chunks.size(); i++ )
+				foreach( 0, _chunks.size(), func );
+			}
+
+			template< typename F > void foreach( std::size_t first, std::size_t last, F func )
+			{
+				for ( size_t i = first; i < last; i++ )
 				{
 					if ( !_chunks[i]->empty() )
 					{
-						address addr;
-						addr.chunk_index = i;
-
-						_chunks[i]->foreach( addr, func );
+						func( address{ i, 0 }, _chunks[i]->size() );
 					}
 				}
 			}
 
 		public:
+			std::size_t chunk_count() const
+			{
+				return _chunks.size();
+			}
+
+			std::size_t chunk_size( std::size_t index ) const
+			{
+				return _chunks[index]->size();
+			}
+
+			std::uint8_t * chunk_data( std::size_t index ) const
+			{
+				return _chunks[index]->data();
+			}
+
+			std::size_t capacity() const
+			{
+				return _capacity;
+			}
+
+			std::span<const std::size_t> offsets() const
+			{
+				return { _offsets.data(), _components.size() };
+			}
+
+			std::uint64_t * versions( std::size_t index ) const
+			{
+				return _chunks[index]->versions();
+			}
+
 			hash_id hash_code() const
 			{
-				std::hash<type_id> hash;
-				std::uint64_t _Val = 14695981039346656037ULL;
-				for ( const auto & it : _components )
-					_Val ^= hash( it.type );
-				return _Val;
+				return _hash;
 			}
 
 			std::span<const component_info> components() const
@@ -417,52 +1296,224 @@ namespace X
 				return { _components };
 			}
 
-			entity_info * find_entity( const address & addr ) const
+			std::size_t column( component_id id ) const
 			{
-				auto it = _entitys.find( addr );
-
-				return it != _entitys.end() ? it->second : nullptr;
+				return id < _columns.size() ? _columns[id] : npos;
 			}
 
-		private:
-			X::memory_resource * _resource;
-			std::pmr::vector<chunk *> _chunks;
-			std::pmr::vector<component_info> _components;
-			std::pmr::map<address, entity_info *> _entitys;
-		};
-
-		template< typename T > struct type
-		{
-			using value_type = std::remove_cvref_t< std::remove_pointer_t< T > >;
+			edge * attach_edge( hash_id key )
+			{
+				auto it = _attachs.find( key );
+				return it != _attachs.end() ? &it->second : nullptr;
+			}
 
-			static X::type_id of()
+			edge * detach_edge( hash_id key )
 			{
-				return value_type::type();
+				auto it = _detachs.find( key );
+				return it != _detachs.end() ? &it->second : nullptr;
 			}
-		};
 
-		template< typename T > struct cast;
-		template< typename T > struct cast< T * >
-		{
-			static T * of( std::uint8_t * ptr )
+			edge & insert_attach_edge( hash_id key, archetype_info * target )
 			{
-				return (T *)ptr;
+				return _attachs.insert( { key, make_edge( target ) } ).first->second;
 			}
-		};
-		template< typename T > struct cast< read< T > >
-		{
-			static read< T > of( std::uint8_t * ptr )
+
+			edge & insert_detach_edge( hash_id key, archetype_info * target )
 			{
-				return (T *)ptr;
+				return _detachs.insert( { key, make_edge( target ) } ).first->second;
 			}
-		};
-		template< typename T > struct cast< write< T > >
-		{
-			static write< T > of( std::uint8_t * ptr )
+
+			std::uint64_t * entity_address( address addr )
 			{
-				return (T *)ptr;
+				return _chunks[addr.chunk_index]->entitys() + addr.address_index;
 			}
-		};
+
+			std::uint64_t find_entity( const address & addr ) const
+			{
+				return _chunks[addr.chunk_index]->entitys()[addr.address_index];
+			}
+
+		private:
+			template< typename I, typename F > void alloc_range( I && ids, std::size_t count, F && func )
+			{
+				for ( std::size_t offset = 0; offset < count; )
+				{
+					if ( _frees.empty() )
+						new_chunk();
+
+					address addr;
+					addr.chunk_index = _frees.back();
+
+					chunk * c = _chunks[addr.chunk_index];
+					addr.address_index = c->size();
+
+					std::size_t size = c->alloc( ids, offset, count - offset );
+					c->touch( *_version );
+					if ( c->full() )
+						_frees.pop_back();
+
+					for ( size_t i = 0; i < _components.size(); i++ )
+						_components[i].construct_range( c->address( addr.address_index, i ), size );
+
+					func( offset, addr, size );
+
+					offset += size;
+				}
+			}
+
+			void drop_chunk( chunk * c )
+			{
+				bool mapped = c->mapped();
+
+				c->~chunk();
+
+				if ( !mapped )
+					_pool->deallocate( c );
+			}
+
+			void new_chunk()
+			{
+				chunk * c = new ( _pool->allocate() ) chunk( _capacity, _offsets, _components );
+				_frees.push_back( _chunks.size() );
+				_chunks.push_back( c );
+			}
+
+			template< typename F > void release_chunk( std::size_t index, F && relocate )
+			{
+				std::size_t last = _chunks.size() - 1;
+
+				_frees.erase( std::find( _frees.begin(), _frees.end(), index ) );
+
+				drop_chunk( _chunks[index] );
+
+				if ( index != last )
+				{
+					_chunks[index] = _chunks[last];
+
+					auto it = std::find( _frees.begin(), _frees.end(), last );
+					if ( it != _frees.end() )
+						*it = index;
+
+					std::uint64_t * ids = _chunks[index]->entitys();
+					for ( size_t i = 0; i < _chunks[index]->size(); i++ )
+						relocate( ids[i], address{ index, i } );
+				}
+
+				_chunks.pop_back();
+			}
+
+			std::size_t layout( std::size_t capacity )
+			{
+				_offsets.clear();
+
+				std::size_t offset = sizeof( std::uint64_t ) * capacity;
+				for ( const auto & it : _components )
+				{
+					std::size_t align = std::max< std::size_t >( it.align, X_CACHE_LINE_SIZE );
+
+					offset = ( offset + align - 1 ) / align * align;
+					_offsets.push_back( offset );
+					offset += it.size * capacity;
+				}
+
+				offset = ( offset + alignof( std::uint64_t ) - 1 ) / alignof( std::uint64_t ) * alignof( std::uint64_t );
+				_offsets.push_back( offset );
+				offset += sizeof( std::uint64_t ) * _components.size();
+
+				return offset;
+			}
+
+			edge make_edge( archetype_info * target ) const
+			{
+				edge result( target, _resource->archetype_resource );
+
+				for ( const auto & it : _components )
+					result.columns.push_back( target->column( it.id ) );
+
+				return result;
+			}
+
+		private:
+			chunk_pool * _pool;
+			const std::uint64_t * _version;
+			X::memory_resource * _resource;
+			std::pmr::vector<chunk *> _chunks;
+			std::pmr::vector<std::size_t> _frees;
+			std::pmr::vector<std::size_t> _offsets;
+			std::pmr::vector<component_info> _components;
+			std::pmr::vector<std::size_t> _columns;
+			std::pmr::unordered_map<hash_id, edge> _attachs;
+			std::pmr::unordered_map<hash_id, edge> _detachs;
+			hash_id _hash;
+			std::size_t _capacity;
+		};
+
+		template< typename T > concept static_type = requires { typename std::integral_constant< hash_id, X::detail::hash( T::type() ) >; };
+
+		template< typename T > struct type
+		{
+			using value_type = std::remove_cvref_t< std::remove_pointer_t< T > >;
+
+			static X::type_id of()
+			{
+				return value_type::type();
+			}
+
+			static hash_id hash()
+			{
+				if constexpr ( static_type< value_type > )
+					return std::integral_constant< hash_id, X::detail::hash( value_type::type() ) >::value;
+				else
+					return X::detail::hash( value_type::type() );
+			}
+
+			static component_id id()
+			{
+				static const component_id value = component_registry::instance().id( hash(), of() );
+				return value;
+			}
+		};
+		template< typename T > struct type< read< T > > : public type< T > {};
+		template< typename T > struct type< write< T > > : public type< T > {};
+		template< typename T > struct type< std::span< T > > : public type< T > {};
+
+		template< typename T > struct cast;
+		template< typename T > struct cast< T * >
+		{
+			static constexpr std::size_t stride = sizeof( T );
+
+			static T * of( std::uint8_t * ptr )
+			{
+				return (T *)ptr;
+			}
+		};
+		template< typename T > struct cast< read< T > >
+		{
+			static constexpr std::size_t stride = sizeof( T );
+
+			static read< T > of( std::uint8_t * ptr )
+			{
+				return (T *)ptr;
+			}
+		};
+		template< typename T > struct cast< write< T > >
+		{
+			static constexpr std::size_t stride = sizeof( T );
+
+			static write< T > of( std::uint8_t * ptr )
+			{
+				return (T *)ptr;
+			}
+		};
+		template< typename T > struct cast< std::span< T > >
+		{
+			static constexpr std::size_t stride = sizeof( T );
+
+			static std::span< T > of( std::uint8_t * ptr, std::size_t count )
+			{
+				return { (T *)ptr, count };
+			}
+		};
 
 		template< typename F > struct __function_traits;
 		template< typename R, typename ...As > struct __function_traits_base
@@ -490,331 +1541,1048 @@ namespace X
 		};
 		template <typename T> static constexpr bool is_load_v = is_load<T>::check( static_cast<T *>( nullptr ) );
 
-		inline hash_id hash_code( std::span< component_info > components )
-		{
-			std::hash<type_id> hash;
-			std::uint64_t _Val = 14695981039346656037ULL;
-			for ( const auto & it : components )
-				_Val ^= hash( it.type );
-			return _Val;
-		}
-	}
+	}
+
+	template< typename T > class graph
+	{
+	public:
+		using edge_id = std::size_t;
+		using vertex_id = std::size_t;
+
+		using vertex_type = T;
+		using edge_type = std::pair< vertex_id, vertex_id >;
+
+	public:
+		static constexpr vertex_id npos = vertex_id( -1 );
+
+	public:
+		graph( X::memory_resource * resource )
+			: _edges( resource->graph_resource ), _vertices( resource->graph_resource )
+		{
+
+		}
+
+	public:
+		vertex_id add_vertex( vertex_type v )
+		{
+			auto id = _vertices.size();
+			_vertices.push_back( v );
+			return id;
+		}
+
+		edge_id add_edge( vertex_id left, vertex_id right )
+		{
+			auto id = _edges.size();
+			_edges.push_back( { left, right } );
+			return id;
+		}
+
+		vertex_id edge_source( edge_id id ) const
+		{
+			return _edges[id].first;
+		}
+
+		vertex_id edge_target( edge_id id ) const
+		{
+			return _edges[id].second;
+		}
+
+	public:
+		template< typename C > void root_vertices( C & container ) const
+		{
+			for ( size_t i = 0; i < _vertices.size(); ++i )
+			{
+				if ( vertex_indegree( i ) == 0 )
+					container.push_back( i );
+			}
+		}
+
+		std::size_t vertex_indegree( vertex_id id ) const
+		{
+			return std::count_if( _edges.begin(), _edges.end(), [id] ( const auto & val ) { return val.second == id; } );
+		}
+
+		vertex_type & vertex( vertex_id id )
+		{
+			return _vertices[id];
+		}
+
+		const vertex_type & vertex( vertex_id id ) const
+		{
+			return _vertices[id];
+		}
+
+		vertex_id vertex_index( const vertex_type & v ) const
+		{
+			auto it = std::find( _vertices.begin(), _vertices.end(), v );
+
+			return it == _vertices.end() ? npos : it - _vertices.begin();
+		}
+
+		vertex_id vertex_source( vertex_id id ) const
+		{
+			auto it = std::find_if( _edges.begin(), _edges.end(), [&id] ( const auto & val ) { return val.second == id; } );
+			if ( it != _edges.end() )
+				return it->first;
+
+			return npos;
+		}
+
+		template< typename C > void vertex_targets( C & container, vertex_id id ) const
+		{
+			for ( const auto & it : _edges )
+			{
+				if ( it.first == id )
+				{
+					container.push_back( it.second );
+				}
+			}
+		}
+
+		void clear()
+		{
+			_edges.clear();
+			_vertices.clear();
+		}
+
+	public:
+		auto vertices_begin()
+		{
+			return _vertices.begin();
+		}
+		auto vertices_end()
+		{
+			return _vertices.end();
+		}
+		auto vertices_begin() const
+		{
+			return _vertices.begin();
+		}
+		auto vertices_end() const
+		{
+			return _vertices.end();
+		}
+		auto edges_begin()
+		{
+			return _edges.begin();
+		}
+		auto edges_begin() const
+		{
+			return _edges.begin();
+		}
+		auto edges_end()
+		{
+			return _edges.end();
+		}
+		auto edges_end() const
+		{
+			return _edges.end();
+		}
+
+	public:
+		std::size_t edges_size() const
+		{
+			return _edges.size();
+		}
+		std::size_t vertices_size() const
+		{
+			return _vertices.size();
+		}
+		const std::pmr::vector< edge_type > & edges() const
+		{
+			return _edges;
+		}
+		const std::pmr::vector< vertex_type > & vertices() const
+		{
+			return _vertices;
+		}
+
+	private:
+		std::pmr::vector< edge_type > _edges;
+		std::pmr::vector< vertex_type > _vertices;
+	};
+
+	class scheduler
+	{
+	private:
+		struct job
+		{
+			job_task task;
+			job * next = nullptr;
+		};
+
+		struct alignas( 64 ) job_cache
+		{
+			static constexpr std::size_t capacity = 256;
+
+			job * head = nullptr;
+			std::size_t size = 0;
+		};
+
+		class job_deque
+		{
+		public:
+			static constexpr std::int64_t capacity = 4096;
+
+		public:
+			bool push( job * val )
+			{
+				auto b = _bottom.load( std::memory_order_relaxed );
+				auto t = _top.load( std::memory_order_acquire );
+				if ( b - t >= capacity )
+					return false;
+
+				_buffer[b & ( capacity - 1 )].store( val, std::memory_order_relaxed );
+				_bottom.store( b + 1, std::memory_order_release );
+				return true;
+			}
+
+			job * pop()
+			{
+				auto b = _bottom.load( std::memory_order_relaxed ) - 1;
+				_bottom.store( b, std::memory_order_seq_cst );
+				auto t = _top.load( std::memory_order_seq_cst );
+
+				if ( t > b )
+				{
+					_bottom.store( b + 1, std::memory_order_relaxed );
+					return nullptr;
+				}
+
+				job * val = _buffer[b & ( capacity - 1 )].load( std::memory_order_relaxed );
+				if ( t == b )
+				{
+					if ( !_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+						val = nullptr;
+
+					_bottom.store( b + 1, std::memory_order_relaxed );
+				}
+				return val;
+			}
+
+			job * steal()
+			{
+				auto t = _top.load( std::memory_order_seq_cst );
+				auto b = _bottom.load( std::memory_order_seq_cst );
+				if ( t >= b )
+					return nullptr;
+
+				job * val = _buffer[t & ( capacity - 1 )].load( std::memory_order_relaxed );
+				if ( !_top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+					return nullptr;
+
+				return val;
+			}
+
+		private:
+			alignas( 64 ) std::atomic< std::int64_t > _top = 0;
+			alignas( 64 ) std::atomic< std::int64_t > _bottom = 0;
+			alignas( 64 ) std::array< std::atomic< job * >, capacity > _buffer = {};
+		};
+
+		struct worker
+		{
+			scheduler * owner;
+			std::size_t index;
+		};
+
+	public:
+		scheduler( const X::memory_resource & resource, size_t thread_count = std::max< size_t >( std::thread::hardware_concurrency(), 1 ) )
+			: _resource( resource ), _tasks( resource.scheduler_resource ), _caches( resource.scheduler_resource ), _threads( resource.scheduler_resource ), _queues( resource.scheduler_resource )
+		{
+			_caches.resize( thread_count );
+			_queues.resize( thread_count );
+			for ( auto & it : _queues )
+			{
+				it = new ( _resource.scheduler_resource->allocate( sizeof( job_deque ), alignof( job_deque ) ) ) job_deque();
+			}
+
+			for ( size_t i = 0; i < thread_count; i++ )
+			{
+				_threads.emplace_back( std::thread( [this, i] ()
+				{
+					_worker = { this, i };
+
+					while ( !_exit.load( std::memory_order_acquire ) )
+					{
+						if ( job * task = acquire( i ) )
+						{
+							execute( task );
+							continue;
+						}
+
+						park( i );
+					}
+
+					_worker = { nullptr, detail::npos };
+				} ) );
+			}
+		}
+
+		~scheduler()
+		{
+			_exit.store( true, std::memory_order_release );
+			_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			_epoch.notify_all();
+
+			for ( auto & it : _threads )
+			{
+				if ( it.joinable() )
+					it.join();
+			}
+
+			for ( auto & it : _queues )
+			{
+				while ( job * task = it->pop() )
+					release( task );
+
+				it->~job_deque();
+				_resource.scheduler_resource->deallocate( it, sizeof( job_deque ), alignof( job_deque ) );
+			}
+
+			for ( auto task : _tasks )
+				release( task );
+
+			for ( auto & it : _caches )
+			{
+				free_jobs( it.head );
+				it.head = nullptr;
+			}
+
+			free_jobs( _frees );
+			_frees = nullptr;
+		}
+
+	public:
+		std::future<void> push_task( job_task task )
+		{
+			std::shared_ptr< std::promise<void> > promise = std::allocate_shared< std::promise<void> >( std::pmr::polymorphic_allocator< std::promise<void> >( _resource.frame_resource ) );
+
+			auto future = promise->get_future();
+
+			post_task( [promise = std::move( promise ), task = std::move( task )] () { if ( task ) task(); promise->set_value(); } );
+
+			return future;
+		}
+
+		void post_task( job_task task )
+		{
+			job * val = new_job();
+			val->task = std::move( task );
+
+			if ( _worker.owner != this || !_queues[_worker.index]->push( val ) )
+			{
+				std::unique_lock< std::mutex > lock( _mutex );
+
+				_tasks.push_back( val );
+				_size.fetch_add( 1, std::memory_order_release );
+			}
+
+			_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			if ( _sleeping.load( std::memory_order_seq_cst ) != 0 )
+				_epoch.notify_one();
+		}
+
+		void wait( std::future<void> & future )
+		{
+			std::size_t index = _worker.owner == this ? _worker.index : detail::npos;
+
+			while ( future.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+			{
+				if ( job * task = acquire( index ) )
+					execute( task );
+				else
+					future.wait_for( std::chrono::microseconds( 50 ) );
+			}
+		}
+
+		void wait( std::atomic< std::size_t > & counter )
+		{
+			std::size_t index = _worker.owner == this ? _worker.index : detail::npos;
+
+			while ( counter.load( std::memory_order_acquire ) != 0 )
+			{
+				if ( job * task = acquire( index ) )
+				{
+					execute( task );
+					continue;
+				}
+
+				_sleeping.fetch_add( 1, std::memory_order_seq_cst );
+				auto epoch = _epoch.load( std::memory_order_seq_cst );
+
+				job * task = nullptr;
+				if ( counter.load( std::memory_order_seq_cst ) != 0 && ( task = acquire( index ) ) == nullptr )
+					_epoch.wait( epoch, std::memory_order_seq_cst );
+
+				_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+
+				if ( task != nullptr )
+					execute( task );
+			}
+		}
+
+		void notify()
+		{
+			_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			_epoch.notify_all();
+		}
+
+	public:
+		X::memory_resource * resource()
+		{
+			return &_resource;
+		}
+
+		std::size_t thread_count() const
+		{
+			return _threads.size();
+		}
+
+		std::size_t worker_index() const
+		{
+			return _worker.owner == this ? _worker.index : detail::npos;
+		}
+
+	private:
+		job * acquire( std::size_t index )
+		{
+			if ( index != detail::npos )
+			{
+				if ( job * task = _queues[index]->pop() )
+					return task;
+			}
+
+			if ( _size.load( std::memory_order_acquire ) != 0 )
+			{
+				std::unique_lock< std::mutex > lock( _mutex );
+
+				if ( !_tasks.empty() )
+				{
+					job * task = _tasks.front();
+					_tasks.pop_front();
+					_size.fetch_sub( 1, std::memory_order_release );
+					return task;
+				}
+			}
+
+			std::size_t start = index == detail::npos ? 0 : index + 1;
+			for ( size_t i = 0; i < _queues.size(); i++ )
+			{
+				std::size_t victim = ( start + i ) % _queues.size();
+				if ( victim == index )
+					continue;
+
+				if ( job * task = _queues[victim]->steal() )
+					return task;
+			}
+
+			return nullptr;
+		}
+
+		void park( std::size_t index )
+		{
+			for ( size_t i = 0; i < 64; i++ )
+			{
+				std::this_thread::yield();
+
+				if ( job * task = acquire( index ) )
+				{
+					execute( task );
+					return;
+				}
+			}
+
+			_sleeping.fetch_add( 1, std::memory_order_seq_cst );
+			auto epoch = _epoch.load( std::memory_order_seq_cst );
+
+			if ( job * task = acquire( index ) )
+			{
+				_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+				execute( task );
+				return;
+			}
+
+			if ( !_exit.load( std::memory_order_acquire ) )
+				_epoch.wait( epoch, std::memory_order_seq_cst );
+
+			_sleeping.fetch_sub( 1, std::memory_order_seq_cst );
+		}
+
+		void execute( job * task )
+		{
+			task->task();
+			release( task );
+		}
+
+		job * new_job()
+		{
+			if ( _worker.owner == this )
+			{
+				auto & cache = _caches[_worker.index];
+
+				if ( cache.head == nullptr )
+				{
+					std::unique_lock< std::mutex > lock( _mutex );
+
+					while ( _frees != nullptr && cache.size < job_cache::capacity / 2 )
+					{
+						job * val = _frees;
+						_frees = val->next;
+						val->next = cache.head;
+						cache.head = val;
+						cache.size++;
+					}
+				}
+
+				if ( job * val = cache.head )
+				{
+					cache.head = val->next;
+					cache.size--;
+					return val;
+				}
+			}
+
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			if ( job * val = _frees )
+			{
+				_frees = val->next;
+				return val;
+			}
+
+			return new ( _resource.scheduler_resource->allocate( sizeof( job ), alignof( job ) ) ) job();
+		}
+
+		void release( job * task )
+		{
+			task->task = nullptr;
+
+			if ( _worker.owner == this )
+			{
+				auto & cache = _caches[_worker.index];
+
+				task->next = cache.head;
+				cache.head = task;
+				if ( ++cache.size <= job_cache::capacity )
+					return;
+
+				job * last = cache.head;
+				for ( size_t i = 1; i < job_cache::capacity / 2; i++ )
+					last = last->next;
+
+				task = cache.head;
+				cache.head = last->next;
+				cache.size -= job_cache::capacity / 2;
+
+				std::unique_lock< std::mutex > lock( _mutex );
+
+				last->next = _frees;
+				_frees = task;
+				return;
+			}
+
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			task->next = _frees;
+			_frees = task;
+		}
+
+		void free_jobs( job * task )
+		{
+			while ( task != nullptr )
+			{
+				job * next = task->next;
+				task->~job();
+				_resource.scheduler_resource->deallocate( task, sizeof( job ), alignof( job ) );
+				task = next;
+			}
+		}
+
+	private:
+		inline static thread_local worker _worker = { nullptr, detail::npos };
+
+	private:
+		std::mutex _mutex;
+		std::atomic< bool > _exit = false;
+		std::atomic< std::size_t > _size = 0;
+		std::atomic< std::size_t > _sleeping = 0;
+		std::atomic< std::uint32_t > _epoch = 0;
+		X::memory_resource _resource;
+		job * _frees = nullptr;
+		std::pmr::deque< job * > _tasks;
+		std::pmr::vector< job_cache > _caches;
+		std::pmr::vector< std::thread > _threads;
+		std::pmr::vector< job_deque * > _queues;
+	};
+
+	class entity
+	{
+	public:
+		static constexpr X::type_id type()
+		{
+			return "entity";
+		}
+
+	public:
+		entity()
+			:_id( detail::npos )
+		{
+
+		}
+
+		entity( std::uint64_t id )
+			:_id( id )
+		{
+
+		}
+
+		entity( std::uint64_t index, std::uint32_t generation )
+			:_id( ( std::uint64_t( generation ) << index_bits ) | ( index & index_mask ) )
+		{
+
+		}
+
+		entity( const entity & val )
+			: _id( val._id )
+		{
+
+		}
+
+		entity & operator=( std::uint64_t id )
+		{
+			_id = id;
+			return *this;
+		}
+
+		entity & operator=( const entity & val )
+		{
+			_id = val._id;
+			return *this;
+		}
+
+	public:
+		operator std::uint64_t() const
+		{
+			return _id;
+		}
+
+	public:
+		std::uint64_t id() const
+		{
+			return _id;
+		}
+
+		std::uint64_t index() const
+		{
+			return _id & index_mask;
+		}
+
+		std::uint32_t generation() const
+		{
+			return static_cast<std::uint32_t>( _id >> index_bits );
+		}
+
+	public:
+		static constexpr std::uint64_t index_bits = 32;
+		static constexpr std::uint64_t index_mask = ( std::uint64_t( 1 ) << index_bits ) - 1;
+
+	private:
+		std::uint64_t _id;
+	};
+
+	class entity_range
+	{
+	public:
+		class iterator
+		{
+		public:
+			using value_type = X::entity;
+			using reference = X::entity;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::random_access_iterator_tag;
+
+		public:
+			iterator() = default;
+
+			iterator( std::uint64_t id )
+				: _id( id )
+			{
+
+			}
+
+		public:
+			X::entity operator*() const
+			{
+				return _id;
+			}
+
+			X::entity operator[]( difference_type n ) const
+			{
+				return _id + n;
+			}
+
+			iterator & operator++()
+			{
+				++_id;
+				return *this;
+			}
+
+			iterator & operator--()
+			{
+				--_id;
+				return *this;
+			}
+
+			iterator operator++( int )
+			{
+				return _id++;
+			}
+
+			iterator operator--( int )
+			{
+				return _id--;
+			}
+
+			iterator & operator+=( difference_type n )
+			{
+				_id += n;
+				return *this;
+			}
+
+			iterator & operator-=( difference_type n )
+			{
+				_id -= n;
+				return *this;
+			}
+
+			friend iterator operator+( iterator it, difference_type n )
+			{
+				return it._id + n;
+			}
+
+			friend iterator operator+( difference_type n, iterator it )
+			{
+				return it._id + n;
+			}
 
-	template< typename T > class graph
-	{
-	public:
-		using edge_id = std::size_t;
-		using vertex_id = std::size_t;
+			friend iterator operator-( iterator it, difference_type n )
+			{
+				return it._id - n;
+			}
 
-		using vertex_type = T;
-		using edge_type = std::pair< vertex_id, vertex_id >;
+			friend difference_type operator-( iterator left, iterator right )
+			{
+				return difference_type( left._id - right._id );
+			}
 
-	public:
-		static constexpr vertex_id npos = vertex_id( -1 );
+			friend auto operator<=>( iterator left, iterator right ) = default;
+
+		private:
+			std::uint64_t _id = 0;
+		};
 
 	public:
-		graph( X::memory_resource * resource )
-			: _edges( resource->graph_resource ), _vertices( resource->graph_resource )
+		entity_range()
+			: _first( 0 ), _last( 0 )
 		{
 
 		}
 
-	public:
-		vertex_id add_vertex( vertex_type v )
+		entity_range( std::uint64_t first, std::uint64_t last )
+			: _first( first ), _last( last )
 		{
-			auto id = _vertices.size();
-			_vertices.push_back( v );
-			return id;
-		}
 
-		edge_id add_edge( vertex_id left, vertex_id right )
-		{
-			auto id = _edges.size();
-			_edges.push_back( { left, right } );
-			return id;
 		}
 
-		vertex_id edge_source( edge_id id ) const
+	public:
+		bool empty() const
 		{
-			return _edges[id].first;
+			return _first == _last;
 		}
 
-		vertex_id edge_target( edge_id id ) const
+		std::size_t size() const
 		{
-			return _edges[id].second;
+			return _last - _first;
 		}
 
-	public:
-		vertex_id root_vertex() const
+		X::entity front() const
 		{
-			for ( size_t i = 0; i < _vertices.size(); ++i )
-			{
-				auto sz = std::count_if( _edges.begin(), _edges.end(), [i] ( const auto & val ) { return val.second == i; } );
-				if ( sz == 0 )
-					return i;
-			}
-
-			return npos;
+			return _first;
 		}
 
-		vertex_type & vertex( vertex_id id )
+		X::entity back() const
 		{
-			return _vertices[id];
+			return _last - 1;
 		}
 
-		const vertex_type & vertex( vertex_id id ) const
+		X::entity operator[]( std::size_t index ) const
 		{
-			return _vertices[id];
+			return _first + index;
 		}
 
-		vertex_id vertex_index( const vertex_type & v ) const
+	public:
+		iterator begin() const
 		{
-			auto it = std::find( _vertices.begin(), _vertices.end(), v );
-
-			return it == _vertices.end() ? npos : it - _vertices.begin();
+			return _first;
 		}
 
-		vertex_id vertex_source( vertex_id id ) const
+		iterator end() const
 		{
-			auto it = std::find_if( _edges.begin(), _edges.end(), [&id] ( const auto & val ) { return val.second == id; } );
-			if ( it != _edges.end() )
-				return it->first;
-
-			return npos;
+			return _last;
 		}
 
-		template< typename C > void vertex_targets( C & container, vertex_id id ) const
-		{
-			for ( const auto & it : _edges )
-			{
-				if ( it.first == id )
-				{
-					container.push_back( it.second );
-				}
-			}
-		}
+	private:
+		std::uint64_t _first;
+		std::uint64_t _last;
+	};
+	template<> struct detail::cast< X::entity >
+	{
+		static constexpr std::size_t stride = sizeof( std::uint64_t );
 
-		void clear()
+		static X::entity of( std::uint8_t * ptr )
 		{
-			_edges.clear();
-			_vertices.clear();
+			return *reinterpret_cast<std::uint64_t *>( ptr );
 		}
+	};
+	static_assert( sizeof( X::entity ) == sizeof( std::uint64_t ), "X::entity must stay layout compatible with the entity column" );
+	template< typename T > using is_entity = std::is_same<T, X::entity >;
+	template< typename T > static constexpr bool is_entity_v = is_entity< T >::value;
 
+	class profiler
+	{
 	public:
-		auto vertices_begin()
-		{
-			return _vertices.begin();
-		}
-		auto vertices_end()
-		{
-			return _vertices.end();
-		}
-		auto vertices_begin() const
+		struct sample
 		{
-			return _vertices.begin();
-		}
-		auto vertices_end() const
-		{
-			return _vertices.end();
-		}
-		auto edges_begin()
-		{
-			return _edges.begin();
-		}
-		auto edges_begin() const
+			std::size_t entities = 0;
+			std::size_t chunks = 0;
+		};
+
+		struct event
 		{
-			return _edges.begin();
-		}
-		auto edges_end()
+			std::size_t name;
+			std::uint64_t frame;
+			std::size_t thread;
+			std::uint64_t posted;
+			std::uint64_t start;
+			std::uint64_t end;
+			sample counts;
+		};
+
+		struct statistics
 		{
-			return _edges.end();
-		}
-		auto edges_end() const
+			std::size_t count = 0;
+			double min = 0;
+			double avg = 0;
+			double p99 = 0;
+			double max = 0;
+			double wait = 0;
+			double entities = 0;
+			double chunks = 0;
+		};
+
+	public:
+		profiler( std::pmr::memory_resource * resource )
+			: _epoch( std::chrono::steady_clock::now() ), _ids( resource ), _names( resource ), _events( resource )
 		{
-			return _edges.end();
+
 		}
 
 	public:
-		std::size_t edges_size() const
+		bool enabled() const
 		{
-			return _edges.size();
+			return _enable.load( std::memory_order_relaxed );
 		}
-		std::size_t vertices_size() const
+
+		void enable( bool val )
 		{
-			return _vertices.size();
+			_enable.store( val, std::memory_order_relaxed );
 		}
-		const std::pmr::vector< edge_type > & edges() const
+
+		void clear()
 		{
-			return _edges;
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			_events.clear();
 		}
-		const std::pmr::vector< vertex_type > & vertices() const
+
+		std::uint64_t now() const
 		{
-			return _vertices;
+			return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - _epoch ).count();
 		}
 
-	private:
-		std::pmr::vector< edge_type > _edges;
-		std::pmr::vector< vertex_type > _vertices;
-	};
+		void record( std::string_view name, std::uint64_t frame, std::size_t thread, std::uint64_t posted, std::uint64_t start, std::uint64_t end, const sample & counts )
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
+
+			_events.push_back( { intern( name ), frame, thread, posted, start, end, counts } );
+		}
 
-	class scheduler
-	{
 	public:
-		scheduler( const X::memory_resource & resource, size_t thread_count = std::thread::hardware_concurrency() * 2 )
-			: _resource( resource ), _tasks( std::pmr::polymorphic_allocator< X::job_task >( resource.scheduler_resource ) ), _threads( resource.scheduler_resource )
+		std::vector< std::string > names() const
 		{
-			for ( size_t i = 0; i < thread_count; i++ )
-			{
-				_threads.emplace_back( std::thread( [this] ()
-				{
-					job_task task;
+			std::unique_lock< std::mutex > lock( _mutex );
 
-					while ( !_exit )
-					{
-						if ( _tasks.empty() )
-						{
-							std::unique_lock< std::mutex > lock( _mutex );
-							_cond.wait( lock );
-						}
+			return { _names.begin(), _names.end() };
+		}
 
-						if ( !_tasks.empty() )
-						{
-							std::unique_lock< std::mutex > lock( _queue );
+		statistics summary( std::string_view name ) const
+		{
+			std::unique_lock< std::mutex > lock( _mutex );
 
-							if ( !_tasks.empty() )
-							{
-								task = std::move( _tasks.front() );
-								_tasks.pop();
-							}
-						}
+			statistics result;
 
-						if ( task )
-						{
-							task();
-							task = nullptr;
-						}
-					}
-				} ) );
-			}
-		}
+			auto it = _ids.find( X::detail::hash( name ) );
+			if ( it == _ids.end() )
+				return result;
 
-		~scheduler()
-		{
-			_exit = true;
-			_cond.notify_all();
-			for ( auto & it : _threads )
+			struct run
 			{
-				if ( it.joinable() )
-					it.join();
-			}
-		}
-
-	public:
-		std::future<void> push_task( job_task task )
-		{
-			std::shared_ptr< std::promise<void> > promise = std::allocate_shared< std::promise<void> >( std::pmr::polymorphic_allocator< std::promise<void> >( _resource.frame_resource ) );
+				std::uint64_t start = std::numeric_limits< std::uint64_t >::max();
+				std::uint64_t end = 0;
+				std::uint64_t wait = 0;
+				sample counts;
+			};
 
-			auto future = promise->get_future();
+			std::map< std::uint64_t, run > runs;
+			for ( const auto & e : _events )
 			{
-				std::unique_lock< std::mutex > lock( _queue );
+				if ( e.name != it->second )
+					continue;
 
-				_tasks.push( [promise = std::move( promise ), task = std::move( task )] () { if ( task ) task(); promise->set_value(); } );
+				auto & r = runs[e.frame];
+				r.start = std::min( r.start, e.start );
+				r.end = std::max( r.end, e.end );
+				r.wait = std::max( r.wait, e.start - e.posted );
+				r.counts.entities += e.counts.entities;
+				r.counts.chunks += e.counts.chunks;
 			}
-			_cond.notify_one();
 
-			return future;
+			if ( runs.empty() )
+				return result;
+
+			std::vector< double > durations;
+			for ( const auto & [frame, r] : runs )
+			{
+				durations.push_back( ( r.end - r.start ) / 1000.0 );
+				result.wait += r.wait / 1000.0;
+				result.entities += r.counts.entities;
+				result.chunks += r.counts.chunks;
+			}
+			std::sort( durations.begin(), durations.end() );
+
+			result.count = durations.size();
+			result.min = durations.front();
+			result.max = durations.back();
+			result.p99 = durations[( durations.size() * 99 + 99 ) / 100 - 1];
+			for ( auto d : durations )
+				result.avg += d;
+			result.avg /= result.count;
+			result.wait /= result.count;
+			result.entities /= result.count;
+			result.chunks /= result.count;
+
+			return result;
 		}
 
-	public:
-		X::memory_resource * resource()
+		void export_chrome_trace( std::ostream & stream ) const
 		{
-			return &_resource;
-		}
+			std::unique_lock< std::mutex > lock( _mutex );
 
-	private:
-		bool _exit = false;
-		std::mutex _mutex, _queue;
-		X::memory_resource _resource;
-		std::condition_variable _cond;
-		std::pmr::vector< std::thread > _threads;
-		std::queue< job_task, std::pmr::deque< job_task > > _tasks;
-	};
+			std::set< std::size_t > threads;
+			for ( const auto & e : _events )
+				threads.insert( e.thread );
 
-	class entity
-	{
-	public:
-		static X::type_id type()
-		{
-			return "entity";
-		}
+			auto flags = stream.flags();
+			auto precision = stream.precision();
 
-	public:
-		entity()
-			:_id( detail::npos )
-		{
+			stream << std::fixed << std::setprecision( 3 ) << "{\"traceEvents\":[";
 
-		}
+			const char * separator = "";
+			for ( auto thread : threads )
+			{
+				stream << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread << ",\"args\":{\"name\":\"";
+				if ( thread == 0 )
+					stream << "main";
+				else
+					stream << "worker " << thread - 1;
+				stream << "\"}}";
+				separator = ",";
+			}
 
-		entity( std::uint64_t id )
-			:_id( id )
-		{
+			for ( const auto & e : _events )
+			{
+				stream << separator << "{\"name\":\"";
+				escape( stream, _names[e.name] );
+				stream << "\",\"cat\":\"xecs\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+					<< ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << ( e.end - e.start ) / 1000.0
+					<< ",\"args\":{\"frame\":" << e.frame << ",\"wait\":" << ( e.start - e.posted ) / 1000.0
+					<< ",\"entities\":" << e.counts.entities << ",\"chunks\":" << e.counts.chunks << "}}";
+				separator = ",";
+			}
 
+			stream << "],\"displayTimeUnit\":\"ms\"}";
+
+			stream.flags( flags );
+			stream.precision( precision );
 		}
 
-		entity( const entity & val )
-			: _id( val._id )
+		bool export_chrome_trace( const std::string & path ) const
 		{
+			std::ofstream stream( path, std::ios::trunc );
+			if ( !stream )
+				return false;
 
+			export_chrome_trace( stream );
+			return stream.good();
 		}
 
-		entity & operator=( std::uint64_t id )
+	private:
+		std::size_t intern( std::string_view name )
 		{
-			_id = id;
-			return *this;
-		}
+			auto hash = X::detail::hash( name );
 
-		entity & operator=( const entity & val )
-		{
-			_id = val._id;
-			return *this;
-		}
+			auto it = _ids.find( hash );
+			if ( it != _ids.end() )
+				return it->second;
 
-	public:
-		operator std::uint64_t() const
-		{
-			return _id;
+			_names.emplace_back( name );
+			return _ids.insert( { hash, _names.size() - 1 } ).first->second;
 		}
 
-	public:
-		std::uint64_t id() const
+		static void escape( std::ostream & stream, std::string_view str )
 		{
-			return _id;
+			for ( char c : str )
+			{
+				if ( c == '"' || c == '\\' )
+					stream << '\\' << c;
+				else if ( static_cast<unsigned char>( c ) < 0x20 )
+					stream << ' ';
+				else
+					stream << c;
+			}
 		}
 
 	private:
-		std::uint64_t _id;
-	};
-	template<> struct detail::cast< X::entity >
-	{
-		static X::entity of( std::uint8_t * ptr )
-		{
-			return reinterpret_cast<X::detail::entity_info *>( ptr )->id;
-		}
+		std::atomic< bool > _enable = false;
+		std::chrono::steady_clock::time_point _epoch;
+		mutable std::mutex _mutex;
+		std::pmr::unordered_map< hash_id, std::size_t > _ids;
+		std::pmr::vector< std::string > _names;
+		std::pmr::vector< event > _events;
 	};
-	template< typename T > using is_entity = std::is_same<T, X::entity >;
-	template< typename T > static constexpr bool is_entity_v = is_entity< T >::value;
 
 	class world
 	{
 	public:
-		static X::type_id type()
+		static constexpr X::type_id type()
 		{
 			return "world";
 		}
 
 	public:
-		world( X::scheduler * scheduler )
-			: _scheduler( scheduler ), _graph( scheduler->resource() ), _free_entity( scheduler->resource()->entity_resource ), _entitys( scheduler->resource()->entity_resource ), _systems( scheduler->resource()->system_resource ), _archetypes( scheduler->resource()->archetype_resource ), _commands( std::pmr::polymorphic_allocator< std::pair< command_type, command > >( scheduler->resource()->command_resource ) )
+		world( X::scheduler * scheduler, std::size_t chunk_size = X_ARCHETYPE_CHUNK_SIZE )
+			: _profiler( scheduler->resource()->system_resource ), _frame_arena( scheduler->resource()->frame_resource ), _scheduler( scheduler ), _graph( scheduler->resource() ), _indegrees( scheduler->resource()->graph_resource ), _jobs( scheduler->resource()->graph_resource ), _dependencies( scheduler->resource()->graph_resource ), _targets( scheduler->resource()->graph_resource ), _free_entity( scheduler->resource()->entity_resource ), _entitys( scheduler->resource()->entity_resource ), _systems( scheduler->resource()->system_resource ), _images( scheduler->resource()->archetype_resource ), _chunk_pool( scheduler->resource()->archetype_resource, sizeof( detail::archetype_info::chunk ) + chunk_size, alignof( detail::archetype_info::chunk ) ), _archetypes( scheduler->resource()->archetype_resource ), _archetype_list( scheduler->resource()->archetype_resource ), _commands( std::pmr::polymorphic_allocator< std::pair< command_type, command > >( scheduler->resource()->command_resource ) )
 		{
 		}
 
@@ -830,9 +2598,9 @@ namespace X
 				info.type = type;
 				unpack_filters< Filter... >( info );
 				unpack_arguments< typename X::detail::function_traits< F >::argument_types >::of( info );
-				info.function = [f = std::move( f )]( std::span< std::uint8_t * > ptrs )
+				info.kernel = [f = std::move( f )]( std::span< std::uint8_t * > columns, std::size_t count )
 				{
-					std::apply( f, trans_arguments< typename X::detail::function_traits< F >::argument_types >::of( ptrs ) );
+					chunk_kernel< typename X::detail::function_traits< F >::argument_types >::of( f, columns, count );
 				};
 			}
 			register_system( type, std::move( info ) );
@@ -840,9 +2608,10 @@ namespace X
 
 		inline void register_system( const type_id & type, X::detail::system_info && sys )
 		{
+			sys.order = _system_order++;
 			_systems.insert( { type, sys } );
 
-			push_command( command_type::BUILD_SYSTEM, [this] () { build(); } );
+			push_command( command_type::BUILD_SYSTEM, [this] () { _dirty = true; } );
 		}
 
 		inline void enable_system( const type_id & type )
@@ -853,7 +2622,7 @@ namespace X
 				if ( it != _systems.end() )
 				{
 					it->second.enable = true;
-					build();
+					_dirty = true;
 				}
 			} );
 		}
@@ -866,7 +2635,19 @@ namespace X
 				if ( it != _systems.end() )
 				{
 					it->second.enable = false;
-					build();
+					_dirty = true;
+				}
+			} );
+		}
+
+		inline void parallel_system( const type_id & type, std::size_t batch )
+		{
+			push_command( command_type::BUILD_SYSTEM, [this, type, batch] ()
+			{
+				auto it = _systems.find( type );
+				if ( it != _systems.end() )
+				{
+					it->second.batch = batch;
 				}
 			} );
 		}
@@ -879,7 +2660,7 @@ namespace X
 				if ( it != _systems.end() )
 				{
 					_systems.erase( it );
-					build();
+					_dirty = true;
 				}
 			} );
 		}
@@ -889,172 +2670,236 @@ namespace X
 		{
 			static_assert( sizeof...( T ) != 0, "The component cannot be empty" );
 			
-			std::pmr::vector<X::detail::component_info> infos( _scheduler->resource()->callstack_resource );
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
 			unpack_components<T...>( infos );
 			return create_entity( infos );
 		}
 
+		template< typename ... T > entity_range create_entities( std::size_t count )
+		{
+			static_assert( sizeof...( T ) != 0, "The component cannot be empty" );
+
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
+			unpack_components<T...>( infos );
+			return create_entities( infos, count );
+		}
+
 		template< typename ... T > void attach_entity( entity id )
 		{
-			std::pmr::vector<X::detail::component_info> infos( _scheduler->resource()->callstack_resource );
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
 			unpack_components<T...>( infos );
 			attach_entity( id, infos );
 		}
 
 		template< typename ... T > void detach_entity( entity id )
 		{
-			std::pmr::vector<X::detail::component_info> infos( _scheduler->resource()->callstack_resource );
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
 			unpack_components<T...>( infos );
 			detach_entity( id, infos );
 		}
 
 		inline entity create_entity( std::span< X::detail::component_info > infos )
 		{
-			std::uint64_t id = 0;
+			register_components( infos );
+
+			auto archetype = X::detail::hash_code( infos );
+			auto it = insert_archetype( archetype, infos );
+
+			std::uint64_t index = 0;
 
 			if ( !_free_entity.empty() )
 			{
-				id = _free_entity.front();
+				index = _free_entity.front();
 				_free_entity.pop_front();
 			}
 			else
 			{
-				id = _entitys.size();
+				index = _entitys.size();
 				_entitys.push_back( {} );
 			}
 
-			auto archetype = X::detail::hash_code( infos );
-			auto it = _archetypes.find( archetype );
-			if ( it == _archetypes.end() )
-			{
-				it = _archetypes.insert( { archetype, { _scheduler->resource(), { infos } } } ).first;
-			}
+			entity id( index, _entitys[index].generation );
 
-			_entitys[id].id = id;
-			_entitys[id].type = it->first;
+			_entitys[index].id = id;
+			_entitys[index].type = it->first;
 
 			push_command( command_type::CREATE_ENTITY, [this, id, archetype] ()
 			{
 				auto it = _archetypes.find( archetype );
 				if ( it != _archetypes.end() )
 				{
-					_entitys[id].address = it->second.alloc( &_entitys[id] );
+					_entitys[id.index()].address = it->second.alloc( id );
 				}
 			} );
 
 			return id;
 		}
 
-		inline void attach_entity( entity id, std::span< X::detail::component_info > infos )
+		inline entity_range create_entities( std::span< X::detail::component_info > infos, std::size_t count )
 		{
-			auto old_archetype = _entitys[id].type;
-			auto old_archetype_it = _archetypes.find( old_archetype );
+			register_components( infos );
+
+			auto archetype = X::detail::hash_code( infos );
+			auto it = insert_archetype( archetype, infos );
 
-			std::pmr::vector<X::detail::component_info> new_infos( _scheduler->resource()->callstack_resource );
-			new_infos.assign( old_archetype_it->second.components().begin(), old_archetype_it->second.components().end() );
-			new_infos.insert( new_infos.end(), infos.begin(), infos.end() );
+			std::uint64_t first = _entitys.size();
+			_entitys.resize( first + count );
 
-			auto new_archetype = X::detail::hash_code( new_infos );
+			for ( std::uint64_t id = first; id < first + count; id++ )
+			{
+				_entitys[id].id = id;
+				_entitys[id].type = it->first;
+			}
 
-			if ( old_archetype != new_archetype )
+			push_command( command_type::CREATE_ENTITY, [this, first, count, archetype] ()
 			{
-				auto new_archetype_it = _archetypes.find( new_archetype );
-				if ( new_archetype_it == _archetypes.end() )
+				auto it = _archetypes.find( archetype );
+				if ( it != _archetypes.end() )
 				{
-					new_archetype_it = _archetypes.insert( { new_archetype, { _scheduler->resource(), { new_infos } } } ).first;
+					it->second.alloc( first, count, [this, first]( std::size_t offset, X::detail::address addr, std::size_t size )
+					{
+						for ( size_t i = 0; i < size; i++ )
+							_entitys[first + offset + i].address = { addr.chunk_index, addr.address_index + i };
+					} );
 				}
+			} );
+
+			return { first, first + count };
+		}
+
+		inline void attach_entity( entity id, std::span< X::detail::component_info > infos )
+		{
+			register_components( infos );
 
-				_entitys[id].type = new_archetype_it->first;
+			push_command( command_type::ATTACH_ENTITY, [this, id, infos = unique_components( infos )] () mutable
+			{
+				if ( !is_alive( id ) )
+					return;
 
-				push_command( command_type::ATTACH_ENTITY, [this, id, old_archetype, new_archetype] ()
+				auto it = _archetypes.find( _entitys[id.index()].type );
+				if ( it != _archetypes.end() )
 				{
-					auto old_it = _archetypes.find( old_archetype );
-					auto new_it = _archetypes.find( new_archetype );
-					auto old_infos = old_it->second.components();
-					auto new_infos = new_it->second.components();
-					auto old_address = _entitys[id].address;
-					auto new_address = new_it->second.alloc( &_entitys[id] );
+					auto & source = it->second;
 
-					for ( size_t i = 0; i < old_infos.size(); i++ )
+					auto key = X::detail::hash_code( infos );
+					auto edge = source.attach_edge( key );
+					if ( edge == nullptr )
 					{
-						size_t j = std::find_if( new_infos.begin(), new_infos.end(), [&] ( const auto & val ) { return val.type == old_infos[i].type; } ) - new_infos.begin();
+						X::detail::scratch_scope scope;
 
-						auto old_ptr = old_it->second.component_address<std::uint8_t>( old_address, i );
-						auto new_ptr = new_it->second.component_address<std::uint8_t>( old_address, j );
+						std::pmr::vector<X::detail::component_info> new_infos( X::scratch_resource::instance() );
+						new_infos.assign( source.components().begin(), source.components().end() );
+						std::copy_if( infos.begin(), infos.end(), std::back_inserter( new_infos ), [&] ( const auto & left ) { return std::find_if( new_infos.begin(), new_infos.end(), [&left] ( const auto & right ) { return left.id == right.id; } ) == new_infos.end(); } );
 
-						old_infos[i].copyassgin( new_ptr, old_ptr );
+						edge = &source.insert_attach_edge( key, &insert_archetype( X::detail::hash_code( new_infos ), new_infos )->second );
 					}
 
-					old_it->second.free( old_address );
-					_entitys[id].address = new_address;
-				} );
-			}
+					move_entity( id, source, *edge );
+				}
+			} );
 		}
 
 		inline void detach_entity( entity id, std::span< X::detail::component_info > infos )
 		{
-			auto old_archetype = _entitys[id].type;
-			auto old_archetype_it = _archetypes.find( old_archetype );
-
-			std::pmr::vector<X::detail::component_info> new_infos( _scheduler->resource()->callstack_resource );
-			new_infos.assign( old_archetype_it->second.components().begin(), old_archetype_it->second.components().end() );
-			new_infos.erase( std::remove_if( new_infos.begin(), new_infos.end(), [&infos] ( const auto & left ) { return std::find_if( infos.begin(), infos.end(), [&left] ( const auto & right ) { return left.type == right.type; } ) != infos.end(); } ), new_infos.end() );
-
-			auto new_archetype = X::detail::hash_code( new_infos );
+			register_components( infos );
 
-			if ( old_archetype != new_archetype )
+			push_command( command_type::DETACH_ENTITY, [this, id, infos = unique_components( infos )] () mutable
 			{
-				auto new_archetype_it = _archetypes.find( new_archetype );
-				if ( new_archetype_it == _archetypes.end() )
-				{
-					new_archetype_it = _archetypes.insert( { new_archetype, { _scheduler->resource(), { new_infos } } } ).first;
-				}
+				if ( !is_alive( id ) )
+					return;
 
-				_entitys[id].type = new_archetype_it->first;
-
-				push_command( command_type::DETACH_ENTITY, [this, id, old_archetype, new_archetype] ()
+				auto it = _archetypes.find( _entitys[id.index()].type );
+				if ( it != _archetypes.end() )
 				{
-					auto old_it = _archetypes.find( old_archetype );
-					auto new_it = _archetypes.find( new_archetype );
-					auto old_infos = old_it->second.components();
-					auto new_infos = new_it->second.components();
-					auto old_address = _entitys[id].address;
-					auto new_address = new_it->second.alloc( &_entitys[id] );
+					auto & source = it->second;
 
-					for ( size_t i = 0; i < new_infos.size(); i++ )
+					auto key = X::detail::hash_code( infos );
+					auto edge = source.detach_edge( key );
+					if ( edge == nullptr )
 					{
-						size_t j = std::find_if( old_infos.begin(), old_infos.end(), [&] ( const auto & val ) { return val.type == new_infos[i].type; } ) - old_infos.begin();
+						X::detail::scratch_scope scope;
 
-						auto new_ptr = new_it->second.component_address<std::uint8_t>( new_address, i );
-						auto old_ptr = old_it->second.component_address<std::uint8_t>( old_address, j );
+						std::pmr::vector<X::detail::component_info> new_infos( X::scratch_resource::instance() );
+						new_infos.assign( source.components().begin(), source.components().end() );
+						new_infos.erase( std::remove_if( new_infos.begin(), new_infos.end(), [&infos] ( const auto & left ) { return std::find_if( infos.begin(), infos.end(), [&left] ( const auto & right ) { return left.id == right.id; } ) != infos.end(); } ), new_infos.end() );
 
-						new_infos[i].copyassgin( new_ptr, old_ptr );
+						edge = &source.insert_detach_edge( key, &insert_archetype( X::detail::hash_code( new_infos ), new_infos )->second );
 					}
 
-					old_it->second.free( old_address );
-					_entitys[id].address = new_address;
-				} );
-			}
+					move_entity( id, source, *edge );
+				}
+			} );
 		}
 
 		inline void destroy_entity( entity id )
 		{
 			push_command( command_type::DESTROY_ENTITY, [this, id] ()
 			{
-				auto it = _archetypes.find( _entitys[id].type );
+				if ( !is_alive( id ) )
+					return;
+
+				auto & info = _entitys[id.index()];
+
+				auto it = _archetypes.find( info.type );
 				if ( it != _archetypes.end() )
 				{
-					it->second.free( _entitys[id].address );
-
-					_entitys[id].id = detail::npos;
-					_entitys[id].type = detail::npos;
-					_entitys[id].address = {};
+					it->second.free( info.address, [this]( std::uint64_t moved, X::detail::address addr ) { _entitys[entity( moved ).index()].address = addr; } );
 				}
 
-				_free_entity.push_back( id );
+				info.id = detail::npos;
+				info.type = detail::npos;
+				info.address = {};
+				info.generation++;
+
+				_free_entity.push_back( id.index() );
 			} );
 		}
 
+		inline bool is_alive( entity id ) const
+		{
+			return id.index() < _entitys.size() && _entitys[id.index()].id == id.id();
+		}
+
+	public:
+		template< typename T > const T & get( entity id )
+		{
+			if ( auto * val = try_get< T >( id ) )
+				return *val;
+
+			throw std::out_of_range( "The entity is not alive or does not have the component" );
+		}
+
+		template< typename T > const T * try_get( entity id )
+		{
+			return locate< T >( id, false );
+		}
+
+		template< typename T > T & modify( entity id )
+		{
+			if ( auto * val = try_modify< T >( id ) )
+				return *val;
+
+			throw std::out_of_range( "The entity is not alive or does not have the component" );
+		}
+
+		template< typename T > T * try_modify( entity id )
+		{
+			return locate< T >( id, true );
+		}
+
+		template< typename T > bool has( entity id )
+		{
+			return try_get< T >( id ) != nullptr;
+		}
+
 	public:
 		inline void startup()
 		{
@@ -1064,10 +2909,18 @@ namespace X
 		inline void update()
 		{
 			_frame++;
+			_version = _frame * 2 + 1;
+
+			std::uint64_t start = profile_time();
 
 			execute();
 
+			if ( start != X::detail::npos )
+				profile( "execute", start, start, {} );
+
 			exec_command();
+
+			_frame_arena.reset();
 		}
 
 		inline void clearup()
@@ -1075,56 +2928,483 @@ namespace X
 			exec_command();
 
 			_frame = 0;
-			_build_frame = -1;
+			_dirty = false;
 
 			_graph.clear();
+			_targets.clear();
 			_entitys.clear();
 			_systems.clear();
 			_archetypes.clear();
+			_images.clear();
 			_free_entity.clear();
+			_archetype_list.clear();
+			_chunk_pool.shrink();
 		}
 
 	public:
-		scheduler * scheduler() const
+		inline bool save( std::ostream & stream )
 		{
-			return _scheduler;
+			write_value< std::uint32_t >( stream, snapshot_magic );
+			write_value< std::uint32_t >( stream, snapshot_version );
+			write_value< std::uint64_t >( stream, _entitys.size() );
+			write_value< std::uint64_t >( stream, _archetype_list.size() );
+
+			for ( const auto & it : _entitys )
+				write_value< std::uint32_t >( stream, it.generation );
+
+			for ( auto archetype : _archetype_list )
+			{
+				auto components = archetype->components();
+
+				write_archetype( stream, *archetype );
+
+				write_value< std::uint64_t >( stream, archetype->chunk_count() );
+				for ( size_t i = 0; i < archetype->chunk_count(); i++ )
+				{
+					X::detail::address addr{ i, 0 };
+					std::size_t count = archetype->chunk_size( i );
+
+					write_value< std::uint64_t >( stream, count );
+					stream.write( reinterpret_cast<const char *>( archetype->entity_address( addr ) ), count * sizeof( std::uint64_t ) );
+
+					for ( size_t j = 0; j < components.size(); j++ )
+					{
+						const auto & info = components[j];
+						std::uint8_t * ptr = archetype->component_address< std::uint8_t >( addr, j );
+
+						if ( info.bitwise_copyable() )
+						{
+							stream.write( reinterpret_cast<const char *>( ptr ), count * info.size );
+						}
+						else if ( info.serialize != nullptr )
+						{
+							for ( size_t k = 0; k < count; k++ )
+								info.serialize( stream, ptr + k * info.size );
+						}
+					}
+				}
+			}
+
+			return stream.good();
 		}
 
-	private:
-		template< typename T > struct trans_arguments;
-		template< typename ... T > struct trans_arguments< std::tuple< T... > >
+		template< typename ... T > bool load( std::istream & stream )
 		{
-		public:
-			static std::tuple< T... > of( std::span< std::uint8_t * > ptrs )
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
+			unpack_components<T...>( infos );
+			return load( stream, infos );
+		}
+
+		inline bool load( std::istream & stream, std::span< X::detail::component_info > infos = {} )
+		{
+			exec_command();
+
+			if ( read_value< std::uint32_t >( stream ) != snapshot_magic || read_value< std::uint32_t >( stream ) != snapshot_version )
+				return false;
+
+			std::uint64_t entity_count = read_value< std::uint64_t >( stream );
+			std::uint64_t archetype_count = read_value< std::uint64_t >( stream );
+			if ( !stream.good() )
+				return false;
+
+			reset_entities( entity_count );
+
+			for ( auto & it : _entitys )
+				it.generation = read_value< std::uint32_t >( stream );
+
+			for ( std::uint64_t a = 0; a < archetype_count; a++ )
+			{
+				X::detail::scratch_scope scope;
+
+				std::pmr::vector< std::size_t > column_map( X::scratch_resource::instance() );
+				auto type = read_archetype( stream, infos, column_map );
+				if ( type == nullptr )
+					return discard_entities();
+
+				auto & archetype = *type;
+				auto columns = archetype.components();
+
+				struct run
+				{
+					X::detail::address addr;
+					std::size_t size;
+				};
+
+				std::pmr::vector< run > runs( X::scratch_resource::instance() );
+				std::pmr::vector< std::uint64_t > ids( X::scratch_resource::instance() );
+
+				std::uint64_t chunk_count = read_value< std::uint64_t >( stream );
+				for ( std::uint64_t c = 0; c < chunk_count; c++ )
+				{
+					std::uint64_t count = read_value< std::uint64_t >( stream );
+					if ( !stream.good() || count > archetype.capacity() )
+						return discard_entities();
+
+					ids.resize( count );
+					stream.read( reinterpret_cast<char *>( ids.data() ), ids.size() * sizeof( std::uint64_t ) );
+
+					if ( !stream.good() || std::any_of( ids.begin(), ids.end(), [entity_count] ( std::uint64_t id ) { return entity( id ).index() >= entity_count; } ) )
+						return discard_entities();
+
+					runs.clear();
+					archetype.alloc( ids, [&] ( std::size_t offset, X::detail::address addr, std::size_t size )
+					{
+						runs.push_back( { addr, size } );
+
+						for ( size_t i = 0; i < size; i++ )
+							restore_entity( ids[offset + i], archetype.hash_code(), { addr.chunk_index, addr.address_index + i } );
+					} );
+
+					for ( size_t j = 0; j < column_map.size(); j++ )
+					{
+						const auto & info = columns[column_map[j]];
+
+						for ( const auto & it : runs )
+						{
+							std::uint8_t * ptr = archetype.component_address< std::uint8_t >( it.addr, column_map[j] );
+
+							if ( info.bitwise_copyable() )
+							{
+								stream.read( reinterpret_cast<char *>( ptr ), it.size * info.size );
+							}
+							else if ( info.deserialize != nullptr )
+							{
+								for ( size_t k = 0; k < it.size; k++ )
+									info.deserialize( stream, ptr + k * info.size );
+							}
+						}
+					}
+				}
+			}
+
+			if ( !stream.good() )
+				return discard_entities();
+
+			rebuild_free_entity();
+
+			return true;
+		}
+
+		inline bool save_image( const std::string & path )
+		{
+			std::ofstream stream( path, std::ios::binary | std::ios::trunc );
+			if ( !stream )
+				return false;
+
+			struct entry
+			{
+				std::uint64_t count;
+				std::uint64_t block;
+				std::uint64_t extra;
+				std::uint64_t extra_size;
+			};
+
+			X::detail::scratch_scope scope;
+
+			const std::size_t header_size = sizeof( X::detail::archetype_info::chunk );
+			const std::size_t chunk_size = _chunk_pool.block_size() - header_size;
+
+			write_value< std::uint32_t >( stream, image_magic );
+			write_value< std::uint32_t >( stream, image_version );
+			write_value< std::uint64_t >( stream, header_size );
+			write_value< std::uint64_t >( stream, chunk_size );
+			write_value< std::uint64_t >( stream, _entitys.size() );
+
+			auto directory_pos = stream.tellp();
+			write_value< std::uint64_t >( stream, 0 );
+
+			std::pmr::vector< entry > entries( X::scratch_resource::instance() );
+			std::pmr::vector< char > block( header_size + chunk_size, 0, X::scratch_resource::instance() );
+
+			for ( auto archetype : _archetype_list )
 			{
-				std::tuple< T... > t;
-				pack< 0, std::tuple< T... >, T... >::of( t, ptrs );
-				return t;
+				auto components = archetype->components();
+				auto offsets = archetype->offsets();
+
+				for ( size_t i = 0; i < archetype->chunk_count(); i++ )
+				{
+					while ( stream.tellp() % X_CACHE_LINE_SIZE != 0 )
+						stream.put( 0 );
+
+					std::memcpy( block.data() + header_size, archetype->chunk_data( i ), chunk_size );
+					for ( size_t j = 0; j < components.size(); j++ )
+					{
+						if ( !components[j].bitwise_copyable() )
+							std::memset( block.data() + header_size + offsets[j], 0, components[j].size * archetype->capacity() );
+					}
+
+					entries.push_back( { archetype->chunk_size( i ), static_cast<std::uint64_t>( stream.tellp() ), 0, 0 } );
+					stream.write( block.data(), block.size() );
+				}
 			}
 
-		private:
-			template< std::size_t N, typename E, typename ... U > struct pack;
+			auto entry = entries.begin();
+			for ( auto archetype : _archetype_list )
+			{
+				auto components = archetype->components();
+
+				for ( size_t i = 0; i < archetype->chunk_count(); i++, entry++ )
+				{
+					X::detail::address addr{ i, 0 };
+
+					entry->extra = stream.tellp();
+					for ( size_t j = 0; j < components.size(); j++ )
+					{
+						const auto & info = components[j];
+						if ( info.bitwise_copyable() || info.serialize == nullptr )
+							continue;
+
+						std::uint8_t * ptr = archetype->component_address< std::uint8_t >( addr, j );
+						for ( size_t k = 0; k < entry->count; k++ )
+							info.serialize( stream, ptr + k * info.size );
+					}
+					entry->extra_size = static_cast<std::uint64_t>( stream.tellp() ) - entry->extra;
+				}
+			}
+
+			std::uint64_t directory = stream.tellp();
+
+			entry = entries.begin();
+			write_value< std::uint64_t >( stream, _archetype_list.size() );
+			for ( const auto & it : _entitys )
+				write_value< std::uint32_t >( stream, it.generation );
+
+			for ( auto archetype : _archetype_list )
+			{
+				write_archetype( stream, *archetype );
+
+				for ( auto offset : archetype->offsets() )
+					write_value< std::uint64_t >( stream, offset );
+
+				write_value< std::uint64_t >( stream, archetype->capacity() );
+				write_value< std::uint64_t >( stream, archetype->chunk_count() );
+				for ( size_t i = 0; i < archetype->chunk_count(); i++, entry++ )
+				{
+					write_value< std::uint64_t >( stream, entry->count );
+					write_value< std::uint64_t >( stream, entry->block );
+					write_value< std::uint64_t >( stream, entry->extra );
+					write_value< std::uint64_t >( stream, entry->extra_size );
+				}
+			}
+
+			stream.seekp( directory_pos );
+			write_value< std::uint64_t >( stream, directory );
+
+			return stream.good();
+		}
+
+		template< typename ... T > bool load_image( const std::string & path )
+		{
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector<X::detail::component_info> infos( X::scratch_resource::instance() );
+			unpack_components<T...>( infos );
+			return load_image( path, infos );
+		}
+
+		inline bool load_image( const std::string & path, std::span< X::detail::component_info > infos = {} )
+		{
+			exec_command();
+
+			X::detail::mapped_file file;
+			if ( !file.open( path ) )
+				return false;
+
+			X::detail::memory_buffer buffer( file.data(), file.size() );
+			std::istream stream( &buffer );
+
+			if ( read_value< std::uint32_t >( stream ) != image_magic || read_value< std::uint32_t >( stream ) != image_version )
+				return false;
+
+			std::uint64_t header_size = read_value< std::uint64_t >( stream );
+			std::uint64_t chunk_size = read_value< std::uint64_t >( stream );
+			std::uint64_t entity_count = read_value< std::uint64_t >( stream );
+			std::uint64_t directory = read_value< std::uint64_t >( stream );
+			if ( !stream.good() || !stream.seekg( directory ) )
+				return false;
+
+			std::uint64_t archetype_count = read_value< std::uint64_t >( stream );
+			if ( !stream.good() )
+				return false;
 
-			template< std::size_t N, typename E, typename U > struct pack< N, E, U >
+			reset_entities( entity_count );
+
+			auto & image = _images.emplace_back( std::move( file ) );
+
+			for ( auto & it : _entitys )
+				it.generation = read_value< std::uint32_t >( stream );
+
+			bool adoptable = header_size == sizeof( X::detail::archetype_info::chunk ) && header_size + chunk_size == _chunk_pool.block_size();
+			bool adopted = false;
+
+			for ( std::uint64_t a = 0; a < archetype_count; a++ )
 			{
-				static void of( E & t, std::span< std::uint8_t * > & p )
+				X::detail::scratch_scope scope;
+
+				std::pmr::vector< std::size_t > column_map( X::scratch_resource::instance() );
+				auto type = read_archetype( stream, infos, column_map );
+				if ( type == nullptr )
+					return discard_entities();
+
+				auto & archetype = *type;
+				auto columns = archetype.components();
+
+				std::pmr::vector< std::size_t > offsets( column_map.size(), 0, X::scratch_resource::instance() );
+				for ( auto & it : offsets )
+					it = read_value< std::uint64_t >( stream );
+
+				std::uint64_t capacity = read_value< std::uint64_t >( stream );
+				std::uint64_t chunk_count = read_value< std::uint64_t >( stream );
+
+				if ( !stream.good() || capacity > chunk_size / sizeof( std::uint64_t ) )
+					return discard_entities();
+
+				for ( size_t j = 0; j < column_map.size(); j++ )
+				{
+					std::size_t size = columns[column_map[j]].size;
+					if ( offsets[j] > chunk_size || ( size != 0 && capacity > ( chunk_size - offsets[j] ) / size ) )
+						return discard_entities();
+				}
+
+				bool adopt = adoptable && capacity == archetype.capacity() && std::equal( offsets.begin(), offsets.end(), archetype.offsets().begin(), archetype.offsets().end() );
+				for ( size_t j = 0; j < column_map.size(); j++ )
+					adopt = adopt && column_map[j] == j && columns[j].bitwise_copyable();
+
+				struct run
+				{
+					X::detail::address addr;
+					std::size_t offset;
+					std::size_t size;
+				};
+
+				std::pmr::vector< run > runs( X::scratch_resource::instance() );
+
+				for ( std::uint64_t c = 0; c < chunk_count; c++ )
 				{
-					if constexpr ( N < std::tuple_size_v< E > )
+					std::uint64_t count = read_value< std::uint64_t >( stream );
+					std::uint64_t block = read_value< std::uint64_t >( stream );
+					std::uint64_t extra = read_value< std::uint64_t >( stream );
+					std::uint64_t extra_size = read_value< std::uint64_t >( stream );
+
+					if ( !stream.good() || count > capacity || block % X_CACHE_LINE_SIZE != 0 || block + header_size + chunk_size > image.size() || extra + extra_size > image.size() )
+						return discard_entities();
+
+					std::uint8_t * data = image.data() + block + header_size;
+					std::span< const std::uint64_t > ids( reinterpret_cast<const std::uint64_t *>( data ), count );
+
+					if ( std::any_of( ids.begin(), ids.end(), [entity_count] ( std::uint64_t id ) { return entity( id ).index() >= entity_count; } ) )
+						return discard_entities();
+
+					if ( count == 0 )
+						continue;
+
+					if ( adopt )
+					{
+						std::size_t index = archetype.adopt( image.data() + block, count );
+
+						for ( size_t i = 0; i < count; i++ )
+							restore_entity( ids[i], archetype.hash_code(), { index, i } );
+
+						adopted = true;
+						continue;
+					}
+
+					runs.clear();
+					archetype.alloc( ids, [&] ( std::size_t offset, X::detail::address addr, std::size_t size )
+					{
+						runs.push_back( { addr, offset, size } );
+
+						for ( size_t i = 0; i < size; i++ )
+							restore_entity( ids[offset + i], archetype.hash_code(), { addr.chunk_index, addr.address_index + i } );
+					} );
+
+					X::detail::memory_buffer extra_buffer( image.data() + extra, extra_size );
+					std::istream extra_stream( &extra_buffer );
+
+					for ( size_t j = 0; j < column_map.size(); j++ )
 					{
-						std::get<N>( t ) = X::detail::cast< U >::of( p[N] );
+						const auto & info = columns[column_map[j]];
+
+						for ( const auto & it : runs )
+						{
+							std::uint8_t * ptr = archetype.component_address< std::uint8_t >( it.addr, column_map[j] );
+
+							if ( info.bitwise_copyable() )
+							{
+								std::memcpy( ptr, data + offsets[j] + it.offset * info.size, it.size * info.size );
+							}
+							else if ( info.deserialize != nullptr )
+							{
+								for ( size_t k = 0; k < it.size; k++ )
+									info.deserialize( extra_stream, ptr + k * info.size );
+							}
+						}
 					}
 				}
-			};
+			}
+
+			if ( !stream.good() )
+				return discard_entities();
+
+			if ( !adopted )
+				_images.pop_back();
+
+			rebuild_free_entity();
+
+			return true;
+		}
+
+	public:
+		X::scheduler * scheduler() const
+		{
+			return _scheduler;
+		}
+
+		X::profiler & profiler()
+		{
+			return _profiler;
+		}
+
+	private:
+		template< typename T > struct chunk_kernel;
+		template< typename ... T > struct chunk_kernel< std::tuple< T... > >
+		{
+		public:
+			static constexpr bool columnar = ( is_span_v< std::remove_cvref_t< T > > || ... );
+
+			static_assert( !columnar || ( ( is_span_v< std::remove_cvref_t< T > > || std::is_same_v< std::remove_cvref_t< T >, X::world * > ) && ... ), "The system function cannot mix std::span arguments with per-entity arguments" );
+
+		public:
+			template< typename F > static void of( F & f, std::span< std::uint8_t * > columns, std::size_t count )
+			{
+				of( f, columns, count, std::index_sequence_for< T... >{} );
+			}
 
-			template< std::size_t N, typename E, typename U, typename ... As > struct pack< N, E, U, As... >
+		private:
+			template< typename F, std::size_t ... I > static void of( F & f, std::span< std::uint8_t * > columns, std::size_t count, std::index_sequence< I... > )
 			{
-				static void of( E & t, std::span< std::uint8_t * > & p )
+				if constexpr ( columnar )
+				{
+					f( column< std::remove_cvref_t< T > >( columns[I], count )... );
+				}
+				else
 				{
-					pack< N, E, U >::of( t, p );
+					std::uint8_t * const bases[sizeof...( T ) + 1] = { columns[I]..., nullptr };
 
-					pack< N + 1, E, As... >::of( t, p );
+					for ( std::size_t i = 0; i < count; i++ )
+						f( X::detail::cast< std::remove_cvref_t< T > >::of( bases[I] + i * X::detail::cast< std::remove_cvref_t< T > >::stride )... );
 				}
-			};
+			}
+
+			template< typename U > static U column( std::uint8_t * ptr, std::size_t count )
+			{
+				if constexpr ( is_span_v< U > )
+					return X::detail::cast< U >::of( ptr, count );
+				else
+					return X::detail::cast< U >::of( ptr );
+			}
 		};
 
 		template< typename T > struct unpack_arguments;
@@ -1141,28 +3421,39 @@ namespace X
 			{
 				using component_type = std::remove_cvref_t< U >;
 
-				if constexpr ( is_read_v< component_type > )
+				if constexpr ( is_span_v< component_type > )
+				{
+					using element_type = typename component_type::element_type;
+
+					if constexpr ( is_entity_v< std::remove_cv_t< element_type > > )
+						static_assert( std::is_const_v< element_type >, "The entity column can only be accessed as std::span<const X::entity>" );
+					else if constexpr ( std::is_const_v< element_type > )
+						container.reads.push_back( X::detail::type< component_type >::id() );
+					else
+						container.writes.push_back( X::detail::type< component_type >::id() );
+				}
+				else if constexpr ( is_read_v< component_type > )
 				{
-					container.reads.push_back( X::detail::type< component_type >::of() );
+					container.reads.push_back( X::detail::type< component_type >::id() );
 				}
 				else if constexpr ( is_write_v< component_type > )
 				{
-					container.writes.push_back( X::detail::type< component_type >::of() );
+					container.writes.push_back( X::detail::type< component_type >::id() );
 				}
 				else if constexpr ( std::is_const_v< std::remove_pointer_t< U > > )
 				{
-					container.reads.push_back( X::detail::type< component_type >::of() );
+					container.reads.push_back( X::detail::type< component_type >::id() );
 				}
-				else if constexpr ( std::is_pointer_v< component_type > && !std::is_same_v< component_type, X::world > )
+				else if constexpr ( std::is_pointer_v< component_type > && !std::is_same_v< component_type, X::world * > )
 				{
-					container.writes.push_back( X::detail::type< component_type >::of() );
+					container.writes.push_back( X::detail::type< component_type >::id() );
 				}
 				else if constexpr ( !is_entity_v< component_type > )
 				{
-					static_assert( std::is_pointer_v< U >, "The system function argument must be either a component pointer or X::world pointer, X::entity, X::read<>, X::write<>, X::ahead<>" );
+					static_assert( std::is_pointer_v< U >, "The system function argument must be either a component pointer or X::world pointer, X::entity, X::read<>, X::write<>, std::span<>, X::ahead<>" );
 				}
 
-				container.arguments.push_back( X::detail::type< component_type >::of() );
+				container.arguments.push_back( X::detail::type< component_type >::id() );
 			}
 		};
 
@@ -1171,7 +3462,7 @@ namespace X
 		{
 			if constexpr ( !std::is_same_v< typename T::this_type, std::identity > )
 			{
-				container.alls.push_back( T::this_type::type() );
+				container.alls.push_back( X::detail::type< typename T::this_type >::id() );
 				unpack_all_filter< typename T::base_type >( container );
 			}
 		}
@@ -1180,7 +3471,7 @@ namespace X
 		{
 			if constexpr ( !std::is_same_v< typename T::this_type, std::identity > )
 			{
-				container.anys.push_back( T::this_type::type() );
+				container.anys.push_back( X::detail::type< typename T::this_type >::id() );
 				unpack_any_filter< typename T::base_type >( container );
 			}
 		}
@@ -1189,11 +3480,20 @@ namespace X
 		{
 			if constexpr ( !std::is_same_v< typename T::this_type, std::identity > )
 			{
-				container.nones.push_back( T::this_type::type() );
+				container.nones.push_back( X::detail::type< typename T::this_type >::id() );
 				unpack_none_filter< typename T::base_type >( container );
 			}
 		}
 
+		template< typename T > void unpack_changed_filter( X::detail::system_info & container )
+		{
+			if constexpr ( !std::is_same_v< typename T::this_type, std::identity > )
+			{
+				container.changes.push_back( X::detail::type< typename T::this_type >::id() );
+				unpack_changed_filter< typename T::base_type >( container );
+			}
+		}
+
 		template< typename T > void unpack_filter( X::detail::system_info & container )
 		{
 			if constexpr ( X::is_all_v< T > )
@@ -1208,6 +3508,14 @@ namespace X
 			{
 				unpack_none_filter< T >( container );
 			}
+			else if constexpr ( X::is_changed_v< T > )
+			{
+				unpack_changed_filter< T >( container );
+			}
+			else if constexpr ( X::is_parallel_v< T > )
+			{
+				container.batch = T::batch;
+			}
 		}
 
 		template< typename ... T > void unpack_filters( X::detail::system_info & container )
@@ -1220,26 +3528,37 @@ namespace X
 		{
 			X::detail::component_info info;
 			info.type = T::type();
+			info.id = X::detail::type< T >::id();
 			info.size = sizeof( T );
-			info.destruct = [] ( std::uint8_t * ptr ) { ( (T *)( ptr ) )->~T(); };
-			info.construct = [] ( std::uint8_t * ptr ) { new ( ptr ) T(); };
-			info.copyassgin = [] ( std::uint8_t * ptr, std::uint8_t * other )
-			{
-				if constexpr ( std::is_move_assignable_v< T > )
-					( (T *)( ptr ) )->operator=( std::move( *( (T *)( other ) ) ) );
-				else
-					( (T *)( ptr ) )->operator=( *( (T *)( other ) ) );
-			};
-			info.serialize = [] ( std::ostream & stream, std::uint8_t * ptr )
-			{
-				if constexpr ( X::detail::is_save_v< T > )
-					( (T *)( ptr ) )->save( stream );
-			};
-			info.deserialize = [] ( std::istream & stream, std::uint8_t * ptr )
+			info.align = alignof( T );
+			static_assert( alignof( T ) <= X_CACHE_LINE_SIZE, "The component alignment cannot exceed X_CACHE_LINE_SIZE" );
+			info.trivially_copyable = std::is_trivially_copyable_v< T >;
+			info.trivially_destructible = std::is_trivially_destructible_v< T >;
+			info.zero_initializable = std::is_trivially_default_constructible_v< T >;
+
+			if constexpr ( !std::is_trivially_destructible_v< T > )
+				info.destruct = [] ( std::uint8_t * ptr ) { ( (T *)( ptr ) )->~T(); };
+
+			if constexpr ( !std::is_trivially_default_constructible_v< T > )
+				info.construct = [] ( std::uint8_t * ptr ) { new ( ptr ) T(); };
+
+			if constexpr ( !std::is_trivially_copyable_v< T > )
 			{
-				if constexpr ( X::detail::is_load_v< T > )
-					( (T *)( ptr ) )->load( stream );
-			};
+				info.copyassgin = [] ( std::uint8_t * ptr, std::uint8_t * other )
+				{
+					if constexpr ( std::is_move_assignable_v< T > )
+						( (T *)( ptr ) )->operator=( std::move( *( (T *)( other ) ) ) );
+					else
+						( (T *)( ptr ) )->operator=( *( (T *)( other ) ) );
+				};
+			}
+
+			if constexpr ( X::detail::is_save_v< T > )
+				info.serialize = [] ( std::ostream & stream, std::uint8_t * ptr ) { ( (T *)( ptr ) )->save( stream ); };
+
+			if constexpr ( X::detail::is_load_v< T > )
+				info.deserialize = [] ( std::istream & stream, std::uint8_t * ptr ) { ( (T *)( ptr ) )->load( stream ); };
+
 			container.emplace_back( std::move( info ) );
 		}
 
@@ -1249,6 +3568,11 @@ namespace X
 		}
 
 	private:
+		static constexpr std::uint32_t snapshot_magic = 0x53434558;
+		static constexpr std::uint32_t snapshot_version = 2;
+		static constexpr std::uint32_t image_magic = 0x474D4958;
+		static constexpr std::uint32_t image_version = 3;
+
 		enum command_type
 		{
 			CREATE_ENTITY = 0,
@@ -1274,11 +3598,18 @@ namespace X
 		{
 			std::unique_lock< std::mutex > lock( _mutex );
 
+			X::profiler::sample counts;
+			std::uint64_t start = profile_time();
+
 			while ( !_commands.empty() )
 			{
 				_commands.top().second();
 				_commands.pop();
+				counts.entities++;
 			}
+
+			if ( start != X::detail::npos )
+				profile( "exec_command", start, start, counts );
 		}
 
 		inline void push_command( command_type type, command cmd )
@@ -1289,186 +3620,568 @@ namespace X
 		}
 
 	private:
-		inline void build()
+		template< typename T > static void write_value( std::ostream & stream, const T & val )
+		{
+			stream.write( reinterpret_cast<const char *>( &val ), sizeof( T ) );
+		}
+
+		template< typename T > static T read_value( std::istream & stream )
+		{
+			T val = {};
+			stream.read( reinterpret_cast<char *>( &val ), sizeof( T ) );
+			return val;
+		}
+
+		inline void write_archetype( std::ostream & stream, const X::detail::archetype_info & archetype )
+		{
+			auto components = archetype.components();
+
+			write_value< std::uint64_t >( stream, components.size() );
+			for ( const auto & it : components )
+			{
+				write_value< std::uint64_t >( stream, it.type.size() );
+				stream.write( it.type.data(), it.type.size() );
+				write_value< std::uint64_t >( stream, it.size );
+			}
+		}
+
+		inline X::detail::archetype_info * read_archetype( std::istream & stream, std::span< X::detail::component_info > infos, std::pmr::vector< std::size_t > & column_map )
 		{
-			if ( _build_frame != _frame )
+			std::pmr::vector< X::detail::component_info > components( X::scratch_resource::instance() );
+			components.resize( read_value< std::uint64_t >( stream ) );
+
+			for ( auto & it : components )
 			{
-				_build_frame = _frame;
+				std::string name( read_value< std::uint64_t >( stream ), '\0' );
+				stream.read( name.data(), name.size() );
+				std::uint64_t size = read_value< std::uint64_t >( stream );
 
-				_graph.clear();
-				for ( auto & it : _systems )
-					_graph.add_vertex( &it.second );
+				auto info = find_component( name, infos );
+				if ( !stream.good() || info == nullptr || info->size != size )
+					return nullptr;
 
-				const auto & vertices = _graph.vertices();
-				std::pmr::vector< std::pmr::vector< size_t > > indegree( _scheduler->resource()->callstack_resource );
-				indegree.resize( vertices.size() );
+				it = *info;
+			}
 
-				for ( size_t i = 0; i < vertices.size(); i++ )
-				{
-					const auto & reads = vertices[i]->reads;
+			register_components( components );
 
-					for ( size_t j = 0; j < vertices.size(); j++ )
-					{
-						if ( i != j )
-						{
-							const auto & write = vertices[j]->writes;
+			auto & archetype = insert_archetype( X::detail::hash_code( components ), components )->second;
+			auto columns = archetype.components();
 
-							if ( std::any_of( write.begin(), write.end(), [&] ( const auto & val ) { return std::find( reads.begin(), reads.end(), val ) != reads.end(); } ) )
-							{
-								indegree[i].push_back( j );
-							}
-						}
-					}
+			for ( const auto & it : components )
+				column_map.push_back( std::find_if( columns.begin(), columns.end(), [&it] ( const auto & val ) { return val.id == it.id; } ) - columns.begin() );
+
+			return &archetype;
+		}
+
+		inline void reset_entities( std::uint64_t entity_count )
+		{
+			for ( auto archetype : _archetype_list )
+				archetype->clear();
+			_images.clear();
+
+			_free_entity.clear();
+			_entitys.assign( entity_count, { X::detail::npos, {}, X::detail::npos } );
+		}
+
+		inline bool discard_entities()
+		{
+			reset_entities( 0 );
+			return false;
+		}
+
+		template< typename T > T * locate( entity id, bool touch )
+		{
+			if ( !is_alive( id ) )
+				return nullptr;
+
+			const auto & info = _entitys[id.index()];
+			if ( info.address.chunk_index == X::detail::npos )
+				return nullptr;
+
+			auto it = _archetypes.find( info.type );
+			if ( it == _archetypes.end() )
+				return nullptr;
+
+			auto column = it->second.column( X::detail::type< T >::id() );
+			if ( column == X::detail::npos )
+				return nullptr;
+
+			if ( touch )
+				it->second.versions( info.address.chunk_index )[column] = _version;
+
+			return it->second.component_address< T >( info.address, column );
+		}
+
+		inline void restore_entity( entity id, hash_id type, X::detail::address address )
+		{
+			_entitys[id.index()] = { type, address, id, id.generation() };
+		}
+
+		inline void rebuild_free_entity()
+		{
+			for ( std::uint64_t id = 0; id < _entitys.size(); id++ )
+			{
+				if ( _entitys[id].id == X::detail::npos )
+					_free_entity.push_back( id );
+			}
+		}
+
+		inline const X::detail::component_info * find_component( std::string_view name, std::span< X::detail::component_info > infos ) const
+		{
+			for ( const auto & it : infos )
+			{
+				if ( it.type == name )
+					return &it;
+			}
+
+			for ( auto archetype : _archetype_list )
+			{
+				for ( const auto & it : archetype->components() )
+				{
+					if ( it.type == name )
+						return &it;
 				}
+			}
+
+			return nullptr;
+		}
+
+		inline std::pmr::unordered_map< hash_id, detail::archetype_info >::iterator insert_archetype( hash_id archetype, std::span< X::detail::component_info > infos )
+		{
+			auto it = _archetypes.find( archetype );
+			if ( it == _archetypes.end() )
+			{
+				it = _archetypes.try_emplace( archetype, _scheduler->resource(), &_chunk_pool, &_version, infos ).first;
+
+				_archetype_list.push_back( &it->second );
+			}
+			return it;
+		}
+
+		inline std::pmr::vector< X::detail::component_info > unique_components( std::span< X::detail::component_info > infos )
+		{
+			std::pmr::vector< X::detail::component_info > result( _scheduler->resource()->command_resource );
+			for ( const auto & it : infos )
+			{
+				if ( std::find_if( result.begin(), result.end(), [&it] ( const auto & val ) { return val.id == it.id; } ) == result.end() )
+					result.push_back( it );
+			}
+			return result;
+		}
+
+		inline void move_entity( entity id, X::detail::archetype_info & archetype, const X::detail::archetype_info::edge & edge )
+		{
+			if ( edge.target == &archetype )
+				return;
 
-				std::pmr::set< const std::pmr::vector< size_t > * > exclude( _scheduler->resource()->callstack_resource );
-				for ( auto it = std::find_if( indegree.begin(), indegree.end(), [] ( const auto & val ) { return val.size() == 0; } ); it != indegree.end(); it = std::find_if( indegree.begin(), indegree.end(), [&exclude] ( const auto & val ) { return val.size() == 0 && exclude.find( &val ) == exclude.end(); } ) )
+			auto old_address = _entitys[id.index()].address;
+			auto new_address = edge.target->alloc( id );
+			auto components = archetype.components();
+
+			for ( size_t i = 0; i < components.size(); i++ )
+			{
+				if ( edge.columns[i] != X::detail::npos )
 				{
-					exclude.insert( &*it );
+					components[i].copy_range( edge.target->component_address<std::uint8_t>( new_address, edge.columns[i] ), archetype.component_address<std::uint8_t>( old_address, i ), 1 );
+				}
+			}
+
+			archetype.free( old_address, [this]( std::uint64_t moved, X::detail::address addr ) { _entitys[entity( moved ).index()].address = addr; } );
+
+			_entitys[id.index()].type = edge.target->hash_code();
+			_entitys[id.index()].address = new_address;
+		}
+
+		inline void register_components( std::span< X::detail::component_info > infos )
+		{
+			for ( auto & it : infos )
+			{
+				if ( it.id == X::detail::npos )
+					it.id = X::detail::component_registry::instance().id( it.type );
+			}
+		}
 
-					auto left_id = it - indegree.begin();
+		inline void match( X::detail::system_info & info )
+		{
+			const auto world_id = X::detail::type< X::world >::id();
+			const auto entity_id = X::detail::type< X::entity >::id();
+
+			for ( ; info.matched < _archetype_list.size(); info.matched++ )
+			{
+				auto archetype = _archetype_list[info.matched];
+				auto components = archetype->components();
+				auto column = [archetype] ( component_id type ) { return archetype->column( type ); };
+				auto contains = [archetype] ( component_id type ) { return archetype->column( type ) != X::detail::npos; };
+
+				if ( !std::all_of( info.arguments.begin(), info.arguments.end(), [&] ( component_id type ) { return type == world_id || type == entity_id || contains( type ); } ) )
+					continue;
+
+				if ( !info.nones.empty() && !std::none_of( info.nones.begin(), info.nones.end(), contains ) )
+					continue;
+
+				if ( !info.alls.empty() && !std::all_of( info.alls.begin(), info.alls.end(), contains ) )
+					continue;
+
+				if ( !info.anys.empty() && !std::any_of( info.anys.begin(), info.anys.end(), contains ) )
+					continue;
+
+				if ( !info.changes.empty() && !std::all_of( info.changes.begin(), info.changes.end(), contains ) )
+					continue;
 
-					for ( auto it1 = indegree.begin(); it1 != indegree.end(); ++it1 )
+				X::detail::query_info query( archetype, _scheduler->resource()->system_resource );
+				for ( auto arg : info.arguments )
+				{
+					if ( arg == world_id )
 					{
-						auto it2 = std::find( it1->begin(), it1->end(), left_id );
-						if ( it2 != it1->end() )
-						{
-							auto right_id = it1 - indegree.begin();
+						query.columns.push_back( X::detail::world_column );
+						query.strides.push_back( 0 );
+					}
+					else if ( arg == entity_id )
+					{
+						query.columns.push_back( X::detail::entity_column );
+						query.strides.push_back( sizeof( std::uint64_t ) );
+					}
+					else
+					{
+						auto index = column( arg );
+						query.columns.push_back( index );
+						query.strides.push_back( components[index].size );
+					}
+				}
+				std::transform( info.writes.begin(), info.writes.end(), std::back_inserter( query.writes ), column );
+				std::transform( info.changes.begin(), info.changes.end(), std::back_inserter( query.changes ), column );
+
+				info.archetypes.emplace_back( std::move( query ) );
+			}
+		}
+
+		inline void build()
+		{
+			_dirty = false;
+
+			_graph.clear();
+
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector< X::detail::system_info * > systems( X::scratch_resource::instance() );
+			for ( auto & it : _systems )
+			{
+				if ( it.second.enable )
+					systems.push_back( &it.second );
+			}
+			std::sort( systems.begin(), systems.end(), [] ( const auto * left, const auto * right ) { return left->order < right->order; } );
+
+			for ( auto it : systems )
+				_graph.add_vertex( it );
+
+			const auto & vertices = _graph.vertices();
+
+			std::pmr::vector< std::pmr::vector< size_t > > indegree( X::scratch_resource::instance() );
+			indegree.resize( vertices.size() );
 
-							it1->erase( it2 );
+			auto reads = [] ( const X::detail::system_info * reader, const X::detail::system_info * writer )
+			{
+				return std::any_of( writer->writes.begin(), writer->writes.end(), [reader] ( const auto & val ) { return std::find( reader->reads.begin(), reader->reads.end(), val ) != reader->reads.end() || std::find( reader->changes.begin(), reader->changes.end(), val ) != reader->changes.end(); } );
+			};
+			auto writes = [] ( const X::detail::system_info * left, const X::detail::system_info * right )
+			{
+				return std::any_of( right->writes.begin(), right->writes.end(), [left] ( const auto & val ) { return std::find( left->writes.begin(), left->writes.end(), val ) != left->writes.end(); } );
+			};
 
-							_graph.add_edge( left_id, right_id );
+			for ( size_t i = 0; i < vertices.size(); i++ )
+			{
+				for ( size_t j = 0; j < vertices.size(); j++ )
+				{
+					if ( i != j )
+					{
+						if ( reads( vertices[i], vertices[j] ) || ( j < i && writes( vertices[i], vertices[j] ) && !reads( vertices[j], vertices[i] ) ) )
+						{
+							indegree[i].push_back( j );
 						}
 					}
 				}
+			}
+
+			std::pmr::set< const std::pmr::vector< size_t > * > exclude( X::scratch_resource::instance() );
+			for ( auto it = std::find_if( indegree.begin(), indegree.end(), [] ( const auto & val ) { return val.size() == 0; } ); it != indegree.end(); it = std::find_if( indegree.begin(), indegree.end(), [&exclude] ( const auto & val ) { return val.size() == 0 && exclude.find( &val ) == exclude.end(); } ) )
+			{
+				exclude.insert( &*it );
+
+				auto left_id = it - indegree.begin();
 
-				for ( const auto & it : indegree )
+				for ( auto it1 = indegree.begin(); it1 != indegree.end(); ++it1 )
 				{
-					if ( !it.empty() )
+					auto it2 = std::find( it1->begin(), it1->end(), left_id );
+					if ( it2 != it1->end() )
 					{
-						_graph.clear();
-						std::cout << "Graph topology sort discovery ring" << std::endl;
-						return;
+						auto right_id = it1 - indegree.begin();
+
+						it1->erase( it2 );
+
+						_graph.add_edge( left_id, right_id );
 					}
 				}
 			}
+
+			for ( const auto & it : indegree )
+			{
+				if ( !it.empty() )
+				{
+					_graph.clear();
+					std::cout << "Graph topology sort discovery ring" << std::endl;
+					break;
+				}
+			}
+
+			_indegrees.clear();
+			_targets.clear();
+			_targets.resize( _graph.vertices_size() );
+			for ( size_t i = 0; i < _graph.vertices_size(); i++ )
+			{
+				_indegrees.push_back( _graph.vertex_indegree( i ) );
+				_graph.vertex_targets( _targets[i], i );
+			}
+			std::pmr::vector< std::atomic< std::size_t > > jobs( _graph.vertices_size(), _scheduler->resource()->graph_resource );
+			std::pmr::vector< std::atomic< std::size_t > > dependencies( _graph.vertices_size(), _scheduler->resource()->graph_resource );
+			_jobs.swap( jobs );
+			_dependencies.swap( dependencies );
 		}
 
 		inline void execute()
 		{
-			std::pmr::vector< std::future< void > > futures( _scheduler->resource()->callstack_resource );
+			if ( _dirty )
+				build();
 
-			auto root = _graph.root_vertex();
-			if ( root != _graph.npos )
-			{
-				std::pmr::deque< X::graph< X::detail::system_info * >::vertex_id > current( _scheduler->resource()->callstack_resource );
-				std::pmr::deque< X::graph< X::detail::system_info * >::vertex_id > nextlayer( _scheduler->resource()->callstack_resource );
+			for ( auto & it : _systems )
+				match( it.second );
+
+			if ( _graph.vertices_size() == 0 )
+				return;
+
+			for ( size_t i = 0; i < _graph.vertices_size(); i++ )
+				_dependencies[i].store( _indegrees[i], std::memory_order_relaxed );
+			_running.store( _graph.vertices_size(), std::memory_order_release );
+
+			X::detail::scratch_scope scope;
+
+			std::pmr::vector< X::graph< X::detail::system_info * >::vertex_id > roots( X::scratch_resource::instance() );
+			_graph.root_vertices( roots );
+			for ( auto id : roots )
+				post( id );
+
+			_scheduler->wait( _running );
+		}
+
+		inline void post( X::graph< X::detail::system_info * >::vertex_id id )
+		{
+			auto info = _graph.vertex( id );
 
-				current.push_back( root );
+			_jobs[id].store( 1, std::memory_order_relaxed );
 
-				do
+			if ( info->batch == 0 )
+			{
+				_jobs[id].fetch_add( 1, std::memory_order_relaxed );
+				_scheduler->post_task( [this, info, id, posted = profile_time()] ()
 				{
-					if ( !nextlayer.empty() )
+					X::profiler::sample counts;
+					std::uint64_t start = posted != X::detail::npos ? _profiler.now() : 0;
+
+					for ( const auto & query : info->archetypes )
 					{
-						current.insert( current.end(), nextlayer.begin(), nextlayer.end() );
-						nextlayer.clear();
+						invoke( info, query, 0, query.archetype->chunk_count(), counts );
 					}
 
-					while ( !current.empty() )
+					if ( posted != X::detail::npos )
+						profile( info->type, posted, start, counts );
+
+					finish( id );
+				} );
+			}
+			else
+			{
+				struct range
+				{
+					const X::detail::query_info * query;
+					std::size_t first, last;
+				};
+
+				std::size_t count = 0;
+				std::pmr::vector< range > ranges( &_frame_arena );
+
+				auto flush = [&] ()
+				{
+					_jobs[id].fetch_add( 1, std::memory_order_relaxed );
+					_scheduler->post_task( [this, info, id, ranges = std::move( ranges ), posted = profile_time()] () mutable
 					{
-						futures.emplace_back( std::move( post( _graph.vertex( current.front() ) ) ) );
+						X::profiler::sample counts;
+						std::uint64_t start = posted != X::detail::npos ? _profiler.now() : 0;
+
+						{
+							auto list = std::move( ranges );
+							for ( const auto & it : list )
+							{
+								invoke( info, *it.query, it.first, it.last, counts );
+							}
+						}
 
-						_graph.vertex_targets( nextlayer, current.front() );
+						if ( posted != X::detail::npos )
+							profile( info->type, posted, start, counts );
 
-						current.pop_front();
-					}
+						finish( id );
+					} );
+
+					count = 0;
+					ranges = std::pmr::vector< range >( &_frame_arena );
+				};
 
-					for ( auto & it : futures )
+				for ( const auto & query : info->archetypes )
+				{
+					for ( size_t i = 0; i < query.archetype->chunk_count(); i++ )
 					{
-						it.wait();
+						auto size = query.archetype->chunk_size( i );
+						if ( size == 0 )
+							continue;
+
+						if ( !ranges.empty() && ranges.back().query == &query && ranges.back().last == i )
+							ranges.back().last = i + 1;
+						else
+							ranges.push_back( { &query, i, i + 1 } );
+
+						count += size;
+						if ( count >= info->batch )
+							flush();
 					}
-					futures.clear();
+				}
 
-				} while ( !nextlayer.empty() );
+				if ( !ranges.empty() )
+					flush();
 			}
+
+			finish( id );
 		}
 
-		inline std::future< void > post( X::detail::system_info * info )
+		inline void finish( X::graph< X::detail::system_info * >::vertex_id id )
 		{
-			std::pmr::vector< hash_id > archetypes( _scheduler->resource()->frame_resource );
+			if ( _jobs[id].fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+				return;
 
-			for ( const auto & it : _archetypes )
+			_graph.vertex( id )->version = _frame * 2;
+
+			for ( auto target : _targets[id] )
 			{
-				auto components = it.second.components();
+				if ( _dependencies[target].fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+					post( target );
+			}
 
-				X::type_list arguments( _scheduler->resource()->callstack_resource );
-				arguments.assign( info->arguments.begin(), info->arguments.end() );
-				arguments.erase( std::remove( arguments.begin(), arguments.end(), "world" ), arguments.end() );
-				arguments.erase( std::remove( arguments.begin(), arguments.end(), "entity" ), arguments.end() );
+			if ( _running.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+				_scheduler->notify();
+		}
 
-				if ( !arguments.empty() && !std::all_of( arguments.begin(), arguments.end(), [&] ( const auto & type ) { return std::find_if( components.begin(), components.end(), [&] ( const auto & component ) { return component.type == type; } ) != components.end(); } ) )
-					continue;
+		inline std::uint64_t profile_time() const
+		{
+			return _profiler.enabled() ? _profiler.now() : X::detail::npos;
+		}
 
-				if ( !info->nones.empty() && !std::none_of( info->nones.begin(), info->nones.end(), [&] ( const auto & type ) { return std::find_if( components.begin(), components.end(), [&] ( const auto & component ) { return component.type == type; } ) != components.end(); } ) )
-					continue;
+		inline void profile( std::string_view name, std::uint64_t posted, std::uint64_t start, const X::profiler::sample & counts )
+		{
+			std::size_t index = _scheduler->worker_index();
 
-				if ( !info->alls.empty() && !std::all_of( info->alls.begin(), info->alls.end(), [&] ( const auto & type ) { return std::find_if( components.begin(), components.end(), [&] ( const auto & component ) { return component.type == type; } ) != components.end(); } ) )
-					continue;
+			_profiler.record( name, _frame, index != X::detail::npos ? index + 1 : 0, posted, start, _profiler.now(), counts );
+		}
 
-				if ( !info->anys.empty() && !std::any_of( info->anys.begin(), info->anys.end(), [&] ( const auto & type ) { return std::find_if( components.begin(), components.end(), [&] ( const auto & component ) { return component.type == type; } ) != components.end(); } ) )
-					continue;
+		inline void invoke( X::detail::system_info * info, const X::detail::query_info & query, std::size_t first, std::size_t last, X::profiler::sample & counts )
+		{
+			X::detail::scratch_scope scope;
 
-				archetypes.push_back( it.first );
-			}
+			std::pmr::vector< std::uint8_t * > arguments( X::scratch_resource::instance() );
+			std::pmr::vector< std::uint8_t * > pointers( X::scratch_resource::instance() );
+
+			auto & type = *query.archetype;
+			const auto & columns = query.columns;
+			const std::uint64_t version = _frame * 2;
 
-			return _scheduler->push_task( [this, info, archetypes = std::move( archetypes )] () mutable
+			arguments.resize( columns.size() );
+			type.foreach( first, last, [&] ( X::detail::address addr, std::size_t count )
 			{
-				for ( auto id : archetypes )
+				std::uint64_t * versions = type.versions( addr.chunk_index );
+
+				if ( !query.changes.empty() && std::none_of( query.changes.begin(), query.changes.end(), [&] ( std::size_t column ) { return versions[column] > info->version; } ) )
+					return;
+
+				for ( auto column : query.writes )
+					versions[column] = version;
+
+				counts.chunks++;
+				counts.entities += count;
+
+				for ( size_t i = 0; i < columns.size(); i++ )
 				{
-					auto it = _archetypes.find( id );
-					if ( it != _archetypes.end() )
+					if ( columns[i] == X::detail::world_column )
 					{
-						auto & type = it->second;
-						std::pmr::vector< std::uint8_t * > arguments( _scheduler->resource()->callstack_resource );
-						type.foreach( [this, info, &type, &arguments] ( X::detail::address addr )
-						{
-							arguments.clear();
-							auto components = type.components();
-							for ( const auto & it : info->arguments )
-							{
-								if ( it == "world" )
-								{
-									arguments.push_back( (std::uint8_t *)this );
-								}
-								else if ( it == "entity" )
-								{
-									arguments.push_back( (std::uint8_t *)type.find_entity( addr ) );
-								}
-								else
-								{
-									arguments.push_back( type.component_address< std::uint8_t >( addr, std::find_if( components.begin(), components.end(), [&it] ( const auto & val ) { return val.type == it; } ) - components.begin() ) );
-								}
-							}
-							info->function( { arguments } );
-						} );
+						arguments[i] = (std::uint8_t *)this;
+					}
+					else if ( columns[i] == X::detail::entity_column )
+					{
+						arguments[i] = (std::uint8_t *)type.entity_address( addr );
+					}
+					else
+					{
+						arguments[i] = type.component_address< std::uint8_t >( addr, columns[i] );
+					}
+				}
+
+				if ( info->kernel )
+				{
+					info->kernel( { arguments }, count );
+				}
+				else
+				{
+					pointers.assign( arguments.begin(), arguments.end() );
+					for ( size_t j = 0; j < count; j++ )
+					{
+						info->function( { pointers } );
+						for ( size_t k = 0; k < pointers.size(); k++ )
+							pointers[k] += query.strides[k];
 					}
 				}
 			} );
 		}
 
 	private:
+		bool _dirty = false;
 		std::uint64_t _frame = 0;
-		std::uint64_t _build_frame = -1;
+		std::size_t _system_order = 0;
+		std::uint64_t _version = 1;
+		X::profiler _profiler;
+		X::detail::frame_arena _frame_arena;
 
 		X::scheduler * _scheduler = nullptr;
 		X::graph< X::detail::system_info * > _graph;
+		std::atomic< std::size_t > _running = 0;
+		std::pmr::vector< std::size_t > _indegrees;
+		std::pmr::vector< std::atomic< std::size_t > > _jobs;
+		std::pmr::vector< std::atomic< std::size_t > > _dependencies;
+		std::pmr::vector< std::pmr::vector< X::graph< X::detail::system_info * >::vertex_id > > _targets;
 
 		std::pmr::deque< std::size_t > _free_entity;
 		std::pmr::vector< detail::entity_info > _entitys;
 		std::pmr::unordered_map< type_id, detail::system_info > _systems;
+		std::pmr::deque< detail::mapped_file > _images;
+		detail::chunk_pool _chunk_pool;
 		std::pmr::unordered_map< hash_id, detail::archetype_info > _archetypes;
+		std::pmr::vector< detail::archetype_info * > _archetype_list;
 
 		std::mutex _mutex;
 		std::priority_queue< std::pair< command_type, command >, std::pmr::deque< std::pair< command_type, command > >, command_less >  _commands;
 	};
+	template<> struct detail::cast< X::world * >
+	{
+		static constexpr std::size_t stride = 0;
+
+		static X::world * of( std::uint8_t * ptr )
+		{
+			return reinterpret_cast<X::world *>( ptr );
+		}
+	};
 }
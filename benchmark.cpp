@@ -0,0 +1,352 @@
+#include "XECS.hpp"
+
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#define component_n( NAME, ... ) \
+struct NAME \
+{ \
+	static X::type_id type() \
+	{ \
+		return #NAME; \
+	} \
+	__VA_ARGS__; \
+};
+
+component_n( position, float x, y, z );
+component_n( velocity, float x, y, z );
+component_n( health, float value );
+component_n( flag, int value );
+
+template< typename T > X::detail::component_info describe( X::type_id type = T::type() )
+{
+	X::detail::component_info info;
+	info.type = type;
+	info.size = sizeof( T );
+	info.align = alignof( T );
+	info.trivially_copyable = true;
+	info.trivially_destructible = true;
+	info.zero_initializable = true;
+	return info;
+}
+
+struct result
+{
+	std::string name;
+	std::size_t entities = 0;
+	std::size_t archetypes = 0;
+	std::size_t systems = 0;
+	std::size_t samples = 0;
+	double total_ms = 0;
+	double avg_ns = 0;
+	double p99_ns = 0;
+	double throughput = 0;
+};
+
+class benchmark
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+public:
+	benchmark( std::size_t threads )
+		: _scheduler( _resource, threads )
+	{
+		_base.push_back( describe< position >() );
+		_base.push_back( describe< velocity >() );
+		_base.push_back( describe< health >() );
+
+		for ( size_t i = 0; i < 10; i++ )
+			_tags.push_back( describe< std::uint32_t >( "tag" + std::to_string( i ) ) );
+	}
+
+public:
+	void create_entity( std::size_t entities, std::size_t archetypes )
+	{
+		X::world world( &_scheduler );
+
+		auto start = clock::now();
+		spawn( world, entities, archetypes );
+		world.startup();
+		report( "create_entity", entities, archetypes, 0, entities, clock::now() - start );
+	}
+
+	void create_entities( std::size_t entities )
+	{
+		X::world world( &_scheduler );
+
+		auto start = clock::now();
+		world.create_entities< position, velocity, health >( entities );
+		world.startup();
+		report( "create_entities", entities, 1, 0, entities, clock::now() - start );
+	}
+
+	void attach_detach( std::size_t entities, std::size_t archetypes )
+	{
+		X::world world( &_scheduler );
+		auto ids = spawn( world, entities, archetypes );
+		world.startup();
+
+		auto start = clock::now();
+		for ( auto id : ids )
+			world.attach_entity< flag >( id );
+		world.startup();
+		for ( auto id : ids )
+			world.detach_entity< flag >( id );
+		world.startup();
+		report( "attach_detach", entities, archetypes, 0, entities * 2, clock::now() - start );
+	}
+
+	void destroy_entity( std::size_t entities, std::size_t archetypes )
+	{
+		X::world world( &_scheduler );
+		auto ids = spawn( world, entities, archetypes );
+		world.startup();
+
+		auto start = clock::now();
+		for ( auto id : ids )
+			world.destroy_entity( id );
+		world.startup();
+		report( "destroy_entity", entities, archetypes, 0, entities, clock::now() - start );
+	}
+
+	void iterate( std::size_t entities, std::size_t archetypes, std::size_t frames )
+	{
+		X::world world( &_scheduler );
+		spawn( world, entities, archetypes );
+		world.register_system( "move", [] ( X::write< position > p, X::read< velocity > v )
+		{
+			p->x += v->x;
+			p->y += v->y;
+			p->z += v->z;
+		}, X::parallel< 16384 >{} );
+		world.startup();
+		world.update();
+
+		std::vector< double > samples;
+		for ( size_t i = 0; i < frames; i++ )
+		{
+			auto start = clock::now();
+			world.update();
+			samples.push_back( std::chrono::duration< double, std::nano >( clock::now() - start ).count() );
+		}
+		report( "iterate", entities, archetypes, 1, samples, entities );
+	}
+
+	void frame( std::size_t entities, std::size_t archetypes, std::size_t frames )
+	{
+		X::world world( &_scheduler );
+		spawn( world, entities, archetypes );
+		world.register_system( "move", [] ( X::write< position > p, X::read< velocity > v ) { p->x += v->x; p->y += v->y; p->z += v->z; }, X::parallel< 16384 >{} );
+		world.register_system( "damp", [] ( X::write< velocity > v ) { v->x *= 0.99f; v->y *= 0.99f; v->z *= 0.99f; }, X::parallel< 16384 >{} );
+		world.register_system( "decay", [] ( X::write< health > h ) { h->value -= 0.01f; }, X::parallel< 16384 >{} );
+		world.register_system( "bounds", [] ( X::read< position > p, X::read< health > h ) { }, X::parallel< 16384 >{} );
+		world.register_system( "count", [] ( X::entity e, X::read< position > p ) { } );
+		world.register_system( "tagged", [] ( X::read< velocity > v ) { }, X::any< flag >{} );
+		world.startup();
+		world.update();
+
+		std::vector< double > samples;
+		for ( size_t i = 0; i < frames; i++ )
+		{
+			auto start = clock::now();
+			world.update();
+			samples.push_back( std::chrono::duration< double, std::nano >( clock::now() - start ).count() );
+		}
+		report( "frame", entities, archetypes, 6, samples, entities );
+	}
+
+	void push_task( std::size_t count )
+	{
+		std::vector< double > samples;
+		for ( size_t i = 0; i < count; i++ )
+		{
+			auto start = clock::now();
+			auto future = _scheduler.push_task( [] () {} );
+			_scheduler.wait( future );
+			samples.push_back( std::chrono::duration< double, std::nano >( clock::now() - start ).count() );
+		}
+		report( "push_task", 0, 0, 0, samples, 1 );
+	}
+
+	void build( std::size_t systems )
+	{
+		X::world world( &_scheduler );
+		for ( size_t i = 0; i < systems; i++ )
+		{
+			switch ( i % 3 )
+			{
+			case 0: world.register_system( "system" + std::to_string( i ), [] ( X::write< position > p, X::read< velocity > v ) {} ); break;
+			case 1: world.register_system( "system" + std::to_string( i ), [] ( X::write< velocity > v ) {} ); break;
+			case 2: world.register_system( "system" + std::to_string( i ), [] ( X::read< position > p, X::write< health > h ) {} ); break;
+			}
+		}
+		world.startup();
+
+		auto start = clock::now();
+		world.update();
+		report( "build", 0, 0, systems, 1, clock::now() - start );
+	}
+
+public:
+	void write_csv( std::ostream & stream ) const
+	{
+		stream << "name,entities,archetypes,systems,samples,total_ms,avg_ns,p99_ns,throughput\n";
+		for ( const auto & it : _results )
+		{
+			stream << it.name << ',' << it.entities << ',' << it.archetypes << ',' << it.systems << ',' << it.samples << ','
+				<< it.total_ms << ',' << it.avg_ns << ',' << it.p99_ns << ',' << it.throughput << '\n';
+		}
+	}
+
+	void write_json( std::ostream & stream ) const
+	{
+		stream << "[\n";
+		for ( size_t i = 0; i < _results.size(); i++ )
+		{
+			const auto & it = _results[i];
+			stream << "  {\"name\":\"" << it.name << "\",\"entities\":" << it.entities << ",\"archetypes\":" << it.archetypes << ",\"systems\":" << it.systems
+				<< ",\"samples\":" << it.samples << ",\"total_ms\":" << it.total_ms << ",\"avg_ns\":" << it.avg_ns << ",\"p99_ns\":" << it.p99_ns
+				<< ",\"throughput\":" << it.throughput << ( i + 1 < _results.size() ? "},\n" : "}\n" );
+		}
+		stream << "]\n";
+	}
+
+private:
+	std::vector< X::entity > spawn( X::world & world, std::size_t entities, std::size_t archetypes )
+	{
+		std::vector< X::entity > ids;
+		ids.reserve( entities );
+
+		std::vector< X::detail::component_info > infos;
+		for ( size_t i = 0; i < entities; i++ )
+		{
+			infos.assign( _base.begin(), _base.end() );
+
+			std::size_t archetype = i % archetypes;
+			for ( size_t j = 0; j < _tags.size(); j++ )
+			{
+				if ( archetype & ( std::size_t( 1 ) << j ) )
+					infos.push_back( _tags[j] );
+			}
+
+			ids.push_back( world.create_entity( infos ) );
+		}
+
+		return ids;
+	}
+
+	void report( const char * name, std::size_t entities, std::size_t archetypes, std::size_t systems, std::size_t operations, clock::duration duration )
+	{
+		result val;
+		val.name = name;
+		val.entities = entities;
+		val.archetypes = archetypes;
+		val.systems = systems;
+		val.samples = 1;
+		val.total_ms = std::chrono::duration< double, std::milli >( duration ).count();
+		val.avg_ns = std::chrono::duration< double, std::nano >( duration ).count() / std::max< std::size_t >( operations, 1 );
+		val.p99_ns = val.avg_ns;
+		val.throughput = operations / std::max( val.total_ms / 1000.0, 1e-9 );
+		push( val );
+	}
+
+	void report( const char * name, std::size_t entities, std::size_t archetypes, std::size_t systems, std::vector< double > samples, std::size_t operations )
+	{
+		std::sort( samples.begin(), samples.end() );
+
+		result val;
+		val.name = name;
+		val.entities = entities;
+		val.archetypes = archetypes;
+		val.systems = systems;
+		val.samples = samples.size();
+		for ( auto it : samples )
+			val.total_ms += it / 1e6;
+		val.avg_ns = val.total_ms * 1e6 / samples.size();
+		val.p99_ns = samples[( samples.size() * 99 + 99 ) / 100 - 1];
+		val.throughput = operations * samples.size() / std::max( val.total_ms / 1000.0, 1e-9 );
+		push( val );
+	}
+
+	void push( const result & val )
+	{
+		fprintf( stderr, "%-16s entities=%-9zu archetypes=%-5zu systems=%-5zu avg=%.1fns p99=%.1fns\n", val.name.c_str(), val.entities, val.archetypes, val.systems, val.avg_ns, val.p99_ns );
+		_results.push_back( val );
+	}
+
+private:
+	X::memory_resource _resource;
+	X::scheduler _scheduler;
+	std::vector< result > _results;
+	std::vector< X::detail::component_info > _base;
+	std::vector< X::detail::component_info > _tags;
+};
+
+int main( int argc, char ** argv )
+{
+	std::string format = "csv";
+	std::string output;
+	std::size_t max_entities = 10000000;
+	std::size_t max_archetypes = 1000;
+	std::size_t max_systems = 1000;
+	std::size_t frames = 20;
+	std::size_t threads = std::max< std::size_t >( std::thread::hardware_concurrency(), 1 );
+
+	for ( int i = 1; i + 1 < argc; i += 2 )
+	{
+		std::string key = argv[i];
+		std::string val = argv[i + 1];
+
+		if ( key == "--format" ) format = val;
+		else if ( key == "--output" ) output = val;
+		else if ( key == "--max-entities" ) max_entities = std::stoull( val );
+		else if ( key == "--max-archetypes" ) max_archetypes = std::stoull( val );
+		else if ( key == "--max-systems" ) max_systems = std::stoull( val );
+		else if ( key == "--frames" ) frames = std::stoull( val );
+		else if ( key == "--threads" ) threads = std::stoull( val );
+		else
+		{
+			fprintf( stderr, "usage: %s [--format csv|json] [--output file] [--max-entities N] [--max-archetypes N] [--max-systems N] [--frames N] [--threads N]\n", argv[0] );
+			return 1;
+		}
+	}
+
+	benchmark bench( threads );
+
+	for ( std::size_t entities = 1000; entities <= max_entities; entities *= 10 )
+	{
+		bench.create_entities( entities );
+
+		for ( std::size_t archetypes = 1; archetypes <= std::min( max_archetypes, entities ); archetypes *= 10 )
+		{
+			bench.create_entity( entities, archetypes );
+			bench.attach_detach( entities, archetypes );
+			bench.destroy_entity( entities, archetypes );
+			bench.iterate( entities, archetypes, frames );
+			bench.frame( entities, archetypes, frames );
+		}
+	}
+
+	bench.push_task( 10000 );
+
+	for ( std::size_t systems = 1; systems <= max_systems; systems *= 10 )
+		bench.build( systems );
+
+	std::ofstream file;
+	if ( !output.empty() )
+		file.open( output, std::ios::trunc );
+	std::ostream & stream = output.empty() ? std::cout : file;
+
+	if ( format == "json" )
+		bench.write_json( stream );
+	else
+		bench.write_csv( stream );
+
+	return 0;
+}
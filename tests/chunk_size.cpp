@@ -0,0 +1,68 @@
+#include "../XECS.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+struct large
+{
+	static X::type_id type()
+	{
+		return "large";
+	}
+	std::uint8_t data[4096];
+};
+
+struct medium
+{
+	static X::type_id type()
+	{
+		return "medium";
+	}
+	std::uint8_t data[1000];
+};
+
+int main()
+{
+	X::memory_resource resource;
+	X::scheduler scheduler( resource, 1 );
+	X::world world( &scheduler, 2048 );
+
+	bool rejected = false;
+	try
+	{
+		world.create_entity< large >();
+	}
+	catch ( const std::length_error & )
+	{
+		rejected = true;
+	}
+
+	if ( !rejected )
+	{
+		printf( "oversized component was not rejected\n" );
+		return 1;
+	}
+
+	std::vector< X::entity > ids;
+	for ( int i = 0; i < 16; i++ )
+		ids.push_back( world.create_entity< medium >() );
+	world.startup();
+
+	for ( std::size_t i = 0; i < ids.size(); i++ )
+	{
+		std::memset( world.modify< medium >( ids[i] ).data, int( i ), sizeof( medium::data ) );
+	}
+
+	for ( std::size_t i = 0; i < ids.size(); i++ )
+	{
+		if ( world.get< medium >( ids[i] ).data[sizeof( medium::data ) - 1] != std::uint8_t( i ) )
+		{
+			printf( "component data was overwritten\n" );
+			return 1;
+		}
+	}
+
+	world.clearup();
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "../XECS.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+struct pos
+{
+	static X::type_id type()
+	{
+		return "pos";
+	}
+	float x, y;
+};
+
+struct vel
+{
+	static X::type_id type()
+	{
+		return "vel";
+	}
+	float x, y;
+};
+
+static std::uint64_t read_u64( std::fstream & file, std::uint64_t offset )
+{
+	std::uint64_t val = 0;
+	file.seekg( offset );
+	file.read( reinterpret_cast<char *>( &val ), sizeof( val ) );
+	return val;
+}
+
+static void corrupt_offset( const char * path, std::uint64_t entity_count )
+{
+	std::fstream file( path, std::ios::binary | std::ios::in | std::ios::out );
+
+	std::uint64_t offset = read_u64( file, 32 ) + sizeof( std::uint64_t ) + sizeof( std::uint32_t ) * entity_count;
+	std::uint64_t components = read_u64( file, offset );
+
+	offset += sizeof( std::uint64_t );
+	for ( std::uint64_t i = 0; i < components; i++ )
+		offset += sizeof( std::uint64_t ) * 2 + read_u64( file, offset );
+
+	std::uint64_t val = 1 << 30;
+	file.seekp( offset );
+	file.write( reinterpret_cast<const char *>( &val ), sizeof( val ) );
+}
+
+static void fill( X::world & world, X::entity_range ids )
+{
+	for ( auto id : ids )
+		world.modify< pos >( id ).x = 1;
+}
+
+static bool check( X::world & world )
+{
+	float sum = 0;
+	world.register_system( "sum", [&sum] ( X::read< pos > p ) { sum += p->x; } );
+	world.startup();
+	world.update();
+
+	return sum == 32;
+}
+
+int main()
+{
+	const char * path = "image_load.img";
+
+	{
+		X::memory_resource resource;
+		X::scheduler scheduler( resource, 1 );
+		X::world world( &scheduler );
+
+		auto a = world.create_entities< pos >( 16 );
+		auto b = world.create_entities< pos, vel >( 16 );
+		world.startup();
+		fill( world, a );
+		fill( world, b );
+
+		if ( !world.save_image( path ) )
+		{
+			printf( "save_image failed\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	X::memory_resource resource;
+	X::scheduler scheduler( resource, 1 );
+
+	{
+		X::world world( &scheduler );
+
+		if ( world.load_image< pos >( path ) )
+		{
+			printf( "image with an unknown component was accepted\n" );
+			return 1;
+		}
+
+		auto ids = world.create_entities< pos >( 32 );
+		world.startup();
+		fill( world, ids );
+
+		if ( !check( world ) )
+		{
+			printf( "world is not usable after a failed load_image\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	{
+		X::world world( &scheduler );
+
+		if ( !world.load_image< pos, vel >( path ) || !check( world ) )
+		{
+			printf( "load_image failed\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	corrupt_offset( path, 32 );
+
+	{
+		X::world world( &scheduler );
+
+		if ( world.load_image< pos, vel >( path ) )
+		{
+			printf( "image with an out of range column offset was accepted\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	std::remove( path );
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include "../XECS.hpp"
+
+#include <cstdio>
+
+struct value
+{
+	static X::type_id type()
+	{
+		return "value";
+	}
+	std::uint64_t x;
+};
+
+int main()
+{
+	std::pmr::unsynchronized_pool_resource pool;
+
+	X::memory_resource resource;
+	resource.scheduler_resource = &pool;
+
+	X::scheduler scheduler( resource, 4 );
+	X::world world( &scheduler );
+
+	auto range = world.create_entities< value >( 100000 );
+
+	world.register_system( "increment", [] ( value * val )
+	{
+		val->x = val->x + 1;
+	}, X::parallel< 64 >{} );
+	world.startup();
+
+	for ( int frame = 0; frame < 64; frame++ )
+		world.update();
+
+	for ( int i = 0; i < 1000; i++ )
+	{
+		auto future = scheduler.push_task( [] () {} );
+		scheduler.wait( future );
+	}
+
+	for ( X::entity e : range )
+	{
+		if ( world.get< value >( e ).x != 64 )
+		{
+			printf( "entity %llu: %llu != 64\n", (unsigned long long)e.id(), (unsigned long long)world.get< value >( e ).x );
+			return 1;
+		}
+	}
+
+	world.clearup();
+
+	return 0;
+}
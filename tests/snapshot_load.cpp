@@ -0,0 +1,112 @@
+#include "../XECS.hpp"
+
+#include <cstdio>
+#include <sstream>
+
+struct pos
+{
+	static X::type_id type()
+	{
+		return "pos";
+	}
+	float x, y;
+};
+
+static bool check( X::world & world, std::size_t count )
+{
+	std::size_t sum = 0;
+	world.register_system( "count", [&sum] ( X::read< pos > p ) { sum++; } );
+	world.startup();
+	world.update();
+
+	return sum == count;
+}
+
+int main()
+{
+	X::memory_resource resource;
+	X::scheduler scheduler( resource, 1 );
+
+	std::string snapshot;
+	{
+		X::world world( &scheduler );
+
+		world.create_entities< pos >( 16 );
+		world.startup();
+
+		std::ostringstream stream;
+		if ( !world.save( stream ) )
+		{
+			printf( "save failed\n" );
+			return 1;
+		}
+		snapshot = stream.str();
+
+		world.clearup();
+	}
+
+	{
+		X::world world( &scheduler );
+
+		std::istringstream stream( snapshot );
+		if ( !world.load< pos >( stream ) || !check( world, 16 ) )
+		{
+			printf( "load failed\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	std::size_t offset = sizeof( std::uint32_t ) * 2 + sizeof( std::uint64_t ) * 2 + sizeof( std::uint32_t ) * 16;
+	offset += sizeof( std::uint64_t ) * 3 + pos::type().size();
+	offset += sizeof( std::uint64_t );
+
+	std::uint64_t count = std::uint64_t( 1 ) << 60;
+	std::string corrupt = snapshot;
+	std::memcpy( corrupt.data() + offset, &count, sizeof( count ) );
+
+	{
+		X::world world( &scheduler );
+
+		auto ids = world.create_entities< pos >( 4 );
+		world.startup();
+
+		std::istringstream stream( corrupt );
+		if ( world.load< pos >( stream ) )
+		{
+			printf( "snapshot with an oversized chunk was accepted\n" );
+			return 1;
+		}
+
+		if ( world.is_alive( *ids.begin() ) )
+		{
+			printf( "world is not empty after a failed load\n" );
+			return 1;
+		}
+
+		world.create_entities< pos >( 8 );
+		if ( !check( world, 8 ) )
+		{
+			printf( "world is not usable after a failed load\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	std::istringstream truncated( snapshot.substr( 0, snapshot.size() - 8 ) );
+	{
+		X::world world( &scheduler );
+
+		if ( world.load< pos >( truncated ) || !check( world, 0 ) )
+		{
+			printf( "truncated snapshot was not rejected\n" );
+			return 1;
+		}
+
+		world.clearup();
+	}
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include "../XECS.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+struct a
+{
+	static X::type_id type()
+	{
+		return "a";
+	}
+	int x;
+};
+
+struct b
+{
+	static X::type_id type()
+	{
+		return "b";
+	}
+	int x;
+};
+
+int main()
+{
+	X::memory_resource resource;
+	X::scheduler scheduler( resource, 4 );
+	X::world world( &scheduler );
+
+	world.create_entity< a >();
+	world.create_entity< b >();
+
+	std::atomic< int > arrived = 0;
+	std::atomic< int > overlapped = 0;
+
+	auto meet = [&] ()
+	{
+		arrived++;
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+		while ( arrived.load() < 2 && std::chrono::steady_clock::now() < deadline )
+			std::this_thread::yield();
+
+		if ( arrived.load() == 2 )
+			overlapped++;
+	};
+
+	world.register_system( "a", [&] ( X::world * w, X::write< a > val ) { meet(); } );
+	world.register_system( "b", [&] ( X::world * w, X::write< b > val ) { meet(); } );
+	world.startup();
+	world.update();
+
+	if ( overlapped.load() != 2 )
+	{
+		printf( "systems taking X::world * over disjoint components were serialized\n" );
+		return 1;
+	}
+
+	world.clearup();
+
+	return 0;
+}
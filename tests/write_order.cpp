@@ -0,0 +1,52 @@
+#include "../XECS.hpp"
+
+#include <cstdio>
+
+struct value
+{
+	static X::type_id type()
+	{
+		return "value";
+	}
+	std::uint64_t x;
+};
+
+int main()
+{
+	X::memory_resource resource;
+	X::scheduler scheduler( resource, 4 );
+	X::world world( &scheduler );
+
+	auto range = world.create_entities< value >( 100000 );
+
+	world.register_system( "double", [] ( std::span< value > values )
+	{
+		for ( auto & it : values )
+			it.x = it.x * 2;
+	}, X::parallel< 1024 >{} );
+	world.register_system( "increment", [] ( value * val )
+	{
+		val->x = val->x + 1;
+	}, X::parallel< 1024 >{} );
+	world.startup();
+
+	for ( int frame = 0; frame < 8; frame++ )
+		world.update();
+
+	std::uint64_t expected = 0;
+	for ( int frame = 0; frame < 8; frame++ )
+		expected = expected * 2 + 1;
+
+	for ( X::entity e : range )
+	{
+		if ( world.get< value >( e ).x != expected )
+		{
+			printf( "entity %llu: %llu != %llu\n", (unsigned long long)e.id(), (unsigned long long)world.get< value >( e ).x, (unsigned long long)expected );
+			return 1;
+		}
+	}
+
+	world.clearup();
+
+	return 0;
+}